@@ -1,578 +1,6216 @@
-#include <iostream>
-#include <sys/time.h>
-#include <cmath>
-#define QUERY_LENGTH 16
-
-using namespace std;
-
-class LLNode
-{
-    public:
-
-    //First 12 characters of fragment for finding index
-    char querySequence[13];
-    //Last 4 characters of fragment in radix form for unique identifier
-    unsigned int radixValue;
-    //Pointer to next node in linked list
-    LLNode *nextNode;
-
-    //Default Constructor for node type
-    //Sets all class variables to default values
-    LLNode();
-
-    //Initialization Constructor for node type
-    //Sets all class variables to provided values
-    LLNode(const char *sequence, unsigned int value);
-
-    //Function to recursively deallocate linked list
-    LLNode *clearList(LLNode *wkgPtr);
-};
-
-class HashLL
-{   
-    public:
-
-    //Pointer to start of linked list
-    LLNode* headPtr;
-
-    //Constructor for linked list type
-    //Sets headPtr to NULL
-    HashLL();
-
-    //Function to append node to end of linked list
-    unsigned int insert(const LLNode &newNode);
-
-    //Starter function to clear linked list
-    void clearList();
-
-    //Function to search for matching value in linked list
-    LLNode *search(unsigned int searchVal);
-};
-
-class Queries_HT
-{
-    public:
-
-    //Pointer to file containing query data
-    FILE *queryFilePointer;
-
-    //Total number of queries in hash table
-    unsigned int numQueries;
-
-    //Number of indices in hash table array
-    unsigned int hashTableSize;
-
-    //Hash table array of linked list pointers
-    HashLL *hashArray;
-
-    //Default Constructor for Hash Table class
-    //Sets all class variables to default values
-    Queries_HT();
-
-    //Initialization Constructor for Hash Table class
-    //Sets all class variables and initializes hash array
-    Queries_HT(FILE *queryFile, int hashSize);
-
-    //Destructor for Hash Table class
-    //Deallocates memory from linked lists and hash array
-    ~Queries_HT();
-
-    //Function to search hash array for matching values
-    bool searchHash(char *searchValue, unsigned int srcIndex);
-
-    //Function to insert new sequence into hash table
-    unsigned int insertSequence(char *newValue);
-
-    //Function to convert character fragments into base-10 integer
-    unsigned int convertToRadix(char *originalString, unsigned int index, unsigned int length);
-
-    //Function to fill hash array using query data
-    unsigned int fillHashes(bool timerFlag);
-
-    private:
-
-    //Function to find hash index for insertion/searching
-    //Dependency: convertToRadix
-    unsigned int findHashIndex(char *valueString, unsigned int index, unsigned int length);
-};
-
-int compareString(const char *oneStr, const char *otherStr);
-unsigned int getStringLength(const char *testStr);
-void copyString(char *destStr, const char *sourceStr);
-
-HashLL::HashLL()
-{
-    //Set headPtr to NULL
-    headPtr = NULL;
-}
-
-unsigned int HashLL::insert(const LLNode &newNode)
-{
-    //Allocate memory for new node
-    LLNode *newPtr = new LLNode(newNode);
-
-    //Check for list empty
-    if(headPtr == NULL)
-    {
-        //Set head to new node
-        headPtr = newPtr;
-    }
-    else
-    {
-        //Initialize working pointer
-        LLNode *wkgPtr = headPtr;
-
-        //Loop to end of linked list
-        while(wkgPtr->nextNode != NULL)
-        {
-            wkgPtr = wkgPtr->nextNode;
-        }
-        //Append new node to end of list
-        wkgPtr->nextNode = newPtr;
-
-        //Return collision detected and resolved
-        return 1u;
-    }
-
-    //Return no collision detected
-    return 0u;
-}
-
-void HashLL::clearList()
-{
-    //Call recursive function to clear list
-    (HashLL* )(headPtr->clearList(headPtr));
-}
-
-LLNode* HashLL::search(unsigned int searchVal)
-{
-    //Initialize working pointer
-    LLNode *wkgPtr = headPtr;
-
-    //Loop until match found or end of list
-    while(wkgPtr != NULL)
-    {
-        //Check for matching value
-        if(searchVal == wkgPtr->radixValue)
-        {
-            //Return pointer to matching node
-            return wkgPtr;
-        }
-        //Move to next node
-        wkgPtr = wkgPtr->nextNode;
-    }
-    //No match found, return NULL
-    return NULL;
-}
-
-LLNode::LLNode()
-{
-    //Set all values to default
-    querySequence[0] = '\0';
-    radixValue = 0;
-    nextNode = NULL;
-}
-
-LLNode::LLNode(const char* sequence, unsigned int value)
-{
-    //Set all values to provided data
-    copyString(querySequence, sequence);
-    radixValue = value;
-    nextNode = NULL;
-}
-
-LLNode* LLNode::clearList(LLNode *wkgPtr)
-{
-    //Check for end of list
-    if(nextNode != NULL)
-    {
-        //Recursively iterate to end of list
-        nextNode = clearList(nextNode);
-    }
-    //Deallocate memory and return NULL
-    delete wkgPtr;
-    return NULL;
-}
-
-Queries_HT::Queries_HT()
-{
-    //Set all values to defaults
-    queryFilePointer = NULL;
-    numQueries = 0;
-    hashTableSize = 0;
-    hashArray = NULL;
-}
-
-Queries_HT::Queries_HT(FILE *queryFile, int hashSize)
-{
-    //Set all values to provided data where applicable
-    queryFilePointer = queryFile;
-    numQueries = 0;
-    hashTableSize = hashSize;
-    hashArray = new HashLL[hashTableSize];
-
-    //Initialize linked lists in all hash indices
-    for(unsigned int index = 0; index < hashTableSize; index++)
-    {
-        hashArray[index] = HashLL();
-    }
-}
-
-Queries_HT::~Queries_HT()
-{
-    //Deallocate hash array
-    delete[] hashArray;
-}
-
-bool Queries_HT::searchHash(char *genomeString, unsigned int srcIndex)
-{
-    //Using 12 characters, calculate radix int to get hash index
-    //(Using all 16 in fragment could cause potential overflow issues)
-    unsigned int radixValue = findHashIndex(genomeString, srcIndex, 12);
-
-
-    //Search for matching radix value in table
-    return (hashArray[radixValue].search(convertToRadix(genomeString, srcIndex + 12, 4)) != NULL);
-}
-
-unsigned int Queries_HT::insertSequence(char *newValue)
-{
-
-    //Using 12 characters, calculate radix int to get hash index
-    //(Using all 16 in fragment could cause potential overflow issues)
-    unsigned int radixValue = findHashIndex(newValue, 0, 12);
-
-    //Create temp string for insertion in new node
-    char hashHalf[13];
-    hashHalf[12] = '\0';
-    int stringIndex = 0;
-    int index;
-    for(index = 0; index < 12; index++, stringIndex++)
-    {
-        hashHalf[index] = newValue[stringIndex];
-        hashHalf[index+1] = '\0';
-    }
-
-    //Insert new node at given hash index
-    numQueries += 1;
-    return hashArray[radixValue].insert(LLNode(hashHalf, convertToRadix(newValue, 12, 4)));
-}
-
-unsigned int Queries_HT::convertToRadix(char *originalString, unsigned int index, unsigned int length)
-{
-    //Initialize intermediate variables
-    unsigned int finalValue = 0;
-    int intermediateValue;
-    int baseValue = 1;
-    unsigned int counter = 0;
-    
-    //While provided length of fragment not reached
-    do
-    {
-        //Check provided character and set base-5 value
-        switch(originalString[index])
-        {
-            case 'N':
-                intermediateValue = 0;
-                break;
-            case 'A':
-                intermediateValue = 1;
-                break;
-            case 'T':
-                intermediateValue = 2;
-                break;
-            case 'C':
-                intermediateValue = 3;
-                break;
-            case 'G':
-                intermediateValue = 4;
-                break;
-        }
-        //Increment final base-10 value
-        finalValue += intermediateValue * baseValue;
-        //Multiply power variable
-        baseValue *= 5;
-        //Increment counters
-        index++;
-        counter++;
-    } while (counter != length);
-
-    //Return base-10 radix value
-    return finalValue;
-    
-}
-
-unsigned int Queries_HT::findHashIndex(char *valueString, unsigned int index, unsigned int length)
-{
-    //Convert valueString to radix form
-    //Range fit resulting radix int to fit in hash table
-    return (convertToRadix(valueString, index, length) % hashTableSize);
-}
-
-unsigned int Queries_HT::fillHashes(bool timerFlag)
-{
-    //Initialize variables
-    unsigned int numCollisions = 0u;
-    struct timeval searchStartTime, searchEndTime;
-    int startSec, endSec, startUSec, endUSec;
-
-    //Check for timer start
-    if(timerFlag)
-    {
-        gettimeofday( &searchStartTime, NULL);
-        startSec = searchStartTime.tv_sec;
-        startUSec = searchStartTime.tv_usec;
-    }
-
-    //Set intChar to start of query file
-    int intChar = fseek(queryFilePointer, 0, SEEK_SET);
-    intChar = fgetc(queryFilePointer);
-    int index = 0;
-    char temp[17];
-    temp[16] = '\0';
-
-    //Loop until end of file
-    while(intChar != EOF)
-    {
-        //Check for current character in alphabet
-        if(intChar >= 65 && intChar <= 90)
-        {
-            temp[index] = (char)(intChar);
-            index++;
-        }
-
-        //Check for full fragment
-        if(index == 16)
-        {
-            numCollisions += insertSequence(temp);
-            numQueries += 1;
-            index = 0;
-        }
-        //Move to next character
-        intChar = fgetc(queryFilePointer);
-    }
-
-    //Check for timer end
-    if(timerFlag)
-    {
-        gettimeofday( &searchEndTime, NULL);
-        endSec = searchEndTime.tv_sec;
-        endUSec = searchEndTime.tv_usec;
-
-        int secDiff = (endSec - startSec);
-        int secUDiff = (endUSec = startUSec);
-
-        cout << "It took " << secDiff << "." << secUDiff 
-                    << " seconds to fill the hash table" << endl;
-    }
-
-    return numCollisions;
-}
-
-int compareString(const char *oneStr, const char *otherStr)
-{
-    //Initialize function/variables
-    int diff, index = 0;
-
-    //Loop to end of shortest string
-    while(oneStr[index] != '\0'
-         && otherStr[index] != '\0')
-    {
-        //Get difference in characters
-        diff = oneStr[index] - otherStr[index];
-        //Check for difference between characters
-        if(diff != 0)
-        {
-            //Difference found, return difference
-            return diff;
-        }
-        //Increment index
-        index++;
-    }
-    //End Loop
-
-    //Return difference in lengths if exists
-        //Function: getStringLength
-    return getStringLength(oneStr) - getStringLength(otherStr);
-}
-
-unsigned int getStringLength(const char *testStr)
-{
-    //Initialize function/variables
-    unsigned int index = 0;
-
-    //Loop to end of string
-    while(testStr[index] != '\0')
-    {
-        //Update index
-        index++;
-    }
-    //End Loop
-
-    //Return index (Max string index is [index-1])
-    return index;
-}
-
-void copyString(char *destStr, const char *sourceStr)
-{
-    //Initialize function/variables
-    int index = 0;
-
-    //Check that source string is not identical to dest string
-    if(compareString(destStr, sourceStr) != 0)
-    {
-        //Loop to end of source string
-        while(sourceStr[index] != '\0' && index < '\0')
-        {
-            //Assign characters to end of dest string
-            destStr[index] = sourceStr[index];
-
-            //Update Index
-            index++;
-
-            //set temp end of dest string
-            destStr[index] = '\0';
-        }
-        //End Loop
-    }
-}
-
-int main(int argc, char **argv)
-{
-    //Initialize variables
-    FILE *genomeFile = fopen(argv[1], "r");
-    FILE *queryFile = fopen(argv[2], "r");
-    bool collisionTimerFlag = false;
-    bool searchTimerFlag = false;
-
-    char *genomeString = NULL;
-
-    int argIndex = 3;
-
-    int intChar;
-
-    unsigned int numCollisions = 0;
-
-    struct timeval searchStartTime, searchEndTime;
-    int startSec, endSec, startUSec, endUSec;
-
-    unsigned int numMatches = 0;
-
-    while (argIndex < argc)
-    {
-        if(compareString(argv[argIndex], "-c") == 0)
-        {
-            collisionTimerFlag = true;
-        }
-        else if(compareString(argv[argIndex], "-s") == 0)
-        {
-            searchTimerFlag = true;
-        }
-        argIndex += 1;
-    }
-
-    //PART ONE
-
-    if(genomeFile != NULL && queryFile != NULL)
-    {
-
-    //Populate each table with query dataset
-    //Count number of collisions and time to populate each table
-        cout << "Creating and filling hash table with size 60 million" << endl;
-        Queries_HT sixtyMSize = Queries_HT(queryFile, 60000000);
-        numCollisions = sixtyMSize.fillHashes(collisionTimerFlag);
-        cout << numCollisions << " collisions were found populating a table of 60 million" << endl;
-
-    //PART TWO
-
-    //Read in genome
-    
-        cout << "Reading Genome File" << endl;
-        unsigned int genomeLength = 0;
-        unsigned int genomeIndex = 0;
-        intChar = fgetc(genomeFile);
-        while(intChar != EOF)
-        {
-            //Increment length of genome
-            genomeLength += (intChar > 64 && intChar < 91);
-            intChar = fgetc(genomeFile);
-        }
-        genomeString = new char[genomeLength+1];
-        fseek(genomeFile, 0, SEEK_SET);
-        intChar = fgetc(genomeFile);
-
-        cout << "Filling Genome String" << endl;
-        while(intChar != EOF)
-        {
-            if(intChar > 64 && intChar < 91)
-            {
-                //Increment length of genome
-                genomeString[genomeIndex] = (char)(intChar);
-                genomeIndex++;
-                genomeString[genomeIndex+1] = '\0';
-            }
-            intChar = fgetc(genomeFile);
-        }
-
-        cout << "Searching Genome String" << endl;
-
-        //For each 16-mer in genome, search for match in query table
-        unsigned int numSubstrings = genomeLength - QUERY_LENGTH + 1;
-        cout << numSubstrings << " Substrings to search" << endl;
-
-        //Check for start timer
-        if(searchTimerFlag)
-        {
-            gettimeofday( &searchStartTime, NULL);
-            startSec = searchStartTime.tv_sec;
-            startUSec = searchStartTime.tv_usec;
-        }
-        
-        //Loop for total number of substrings in genome
-        for(unsigned int index = 0; index < numSubstrings; index++)
-        {
-            //Check for successful search
-            if(sixtyMSize.searchHash(genomeString, index))
-            {
-                //Increment number of found matches
-                numMatches += 1;
-                if(numMatches > 0 && numMatches < 16)
-                {
-                    unsigned int srcIndex = index;
-                    char tempPrint[17];
-                    tempPrint[16] = '\0';
-                    for(unsigned int tempIndex = 0; tempIndex < 16; tempIndex++, srcIndex++)
-                    {
-                        tempPrint[tempIndex] = genomeString[srcIndex];
-                    }
-                    cout << "Fragment " << numMatches << " " << tempPrint << endl;
-                }
-            }
-        }
-        cout << numMatches << " matches found" << endl;
-
-        //Check for end timer
-        if(searchTimerFlag)
-        {
-            gettimeofday( &searchEndTime, NULL);
-            endSec = searchEndTime.tv_sec;
-            endUSec = searchEndTime.tv_usec;
-
-            int secDiff = (endSec - startSec);
-            int secUDiff = (endUSec - startUSec);
-
-            cout << "It took " << secDiff << "." << secUDiff 
-                    << " seconds to search the hash table" << endl;
-        }
-
-        cout << "Clearing Hash" << endl;
-    }
-    else
-    {
-        cout << "Genome or Query File not found" << endl;
-        cout << "Please check your file names and try again" << endl;
-        return 1;
-    }
-    cout << "Program End" << endl;
-    return 0;
-}
+#include <iostream>
+#include <sys/time.h>
+#include <cmath>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_SIMD
+#endif
+#define QUERY_LENGTH 16
+#define INDEX_PLACE_VALUE 244140625ull
+#define EMPTY_SLOT 0xFFFFFFFFFFFFFFFFull
+#define DEFAULT_LOAD_FACTOR 0.75
+#define NULL_NODE 0xFFFFFFFFu
+#define SLAB_BITS 14
+#define SLAB_NODES (1u << SLAB_BITS)
+#define MAX_PRINTED_MATCHES 15
+#define INVALID_BASE 0xFFu
+#define INVALID_QUERY 0xFFFFFFFFu
+#define SCAN_BLOCK 4096
+#define BLOOM_BLOCK_WORDS 8
+#define BLOOM_MAX_HASHES 16
+#define BACKEND_CHAIN 0
+#define BACKEND_FLAT 1
+#define BACKEND_SORTED 2
+#define BACKEND_APPROX 3
+#define BACKEND_PERFECT 4
+#define BACKEND_BITMAP 5
+#define INVALID_PACKED 4u
+#define MAX_KMER_LENGTH 32
+#define INDEX_MAGIC 0x5844494D47514347ull
+#define INDEX_VERSION 2u
+#define INDEX_HEADER_BYTES 64
+#define INDEX_ALIGN 64
+#define STREAM_BLOCK 65536
+#define RECORD_SEPARATOR '|'
+#define HALF_LENGTH 8
+#define HALF_PLACE_VALUE 390625ull
+#define BENCH_REPEATS 3
+#define DEFAULT_BATCH 16
+#define MAX_BATCH 256
+#define INTERLEAVE_WIDTH 8
+#define PROBE_HEAD 0
+#define PROBE_NODE 1
+#define FASTA_LINE_LENGTH 60
+#define CHAIN_HISTOGRAM_BINS 16
+#define NUM_COUNTERS 5
+#define PAGES_NORMAL 0
+#define PAGES_HUGE 1
+#define SMALL_PAGE_BYTES 4096ull
+#define HUGE_PAGE_BYTES (2ull << 20)
+#define MPOL_INTERLEAVE_MODE 3
+#define MAX_NUMA_NODES 1024
+#define PERFECT_BUCKET_KEYS 5
+#define PERFECT_FILL 0.98
+#define MAX_PILOT 65535
+#define BUCKET_SEED 0x9E3779B97F4A7C15ull
+#define SLOT_SEED 0xD1B54A32D192ED03ull
+#define PACKED_KEY_BYTES 5
+#define PACKED_KEY_MASK 0xFFFFFFFFFFull
+#define BITMAP_BYTES (1ull << 29)
+#define CHUNK_VALUES 625
+#define CHUNK_HAS_N 0x100
+
+using namespace std;
+
+class PagePolicy
+{
+    public:
+
+    //Page size asked for by large buffers, PAGES_NORMAL or PAGES_HUGE
+    static unsigned int pageMode;
+
+    //Flag to spread pages of large buffers over every NUMA node
+    static bool interleaveFlag;
+
+    //Bytes placed on explicit huge pages, on pages advised for transparent huge pages and on normal pages
+    static unsigned long long hugeBytes;
+    static unsigned long long transparentBytes;
+    static unsigned long long normalBytes;
+
+    //Function to map zeroed buffer of at least numBytes using current policy
+    //Explicit huge pages are tried first, then transparent huge pages, then normal pages
+    static void *allocateBuffer(unsigned long long numBytes);
+
+    //Function to unmap buffer from allocateBuffer, numBytes must match
+    static void releaseBuffer(void *bufferData, unsigned long long numBytes);
+
+    //Function to find mapped length of buffer of numBytes
+    //Buffers of a huge page or more are rounded to whole huge pages under every policy,
+    //so release never needs to know which policy was used
+    static unsigned long long mappedLength(unsigned long long numBytes);
+
+    //Function to ask kernel to interleave pages of fresh mapping over online NUMA nodes
+    //Does nothing on single node hosts or kernels without NUMA
+    static void interleavePages(void *bufferData, unsigned long long mapLength);
+};
+
+class LLNode
+{
+    public:
+
+    //First 12 characters of fragment for finding index
+    char querySequence[13];
+    //Last 4 characters of fragment in radix form for unique identifier
+    unsigned int radixValue;
+    //First 12 characters of fragment in radix form before range fitting
+    unsigned int indexValue;
+    //Arena index of next node in linked list (NULL_NODE at end)
+    unsigned int nextNode;
+
+    //Default Constructor for node type
+    //Sets all class variables to default values
+    LLNode();
+
+    //Initialization Constructor for node type
+    //Sets all class variables to provided values
+    LLNode(const char *sequence, unsigned int value);
+
+    //Initialization Constructor for node type
+    //Also stores radix form of first 12 characters
+    LLNode(const char *sequence, unsigned int index, unsigned int value);
+};
+
+class NodeArena
+{
+    public:
+
+    //Array of pointers to slabs of SLAB_NODES nodes each
+    LLNode **slabArray;
+
+    //Number of slabs allocated
+    unsigned int numSlabs;
+
+    //Number of slab pointers slabArray can hold
+    unsigned int slabCapacity;
+
+    //Number of nodes handed out from slabs
+    unsigned int numNodes;
+
+    //Flag for slabs pointing into mapped index file rather than owned memory
+    //Mapped arenas are read only
+    bool mappedFlag;
+
+    //Constructor for arena type
+    //Sets arena to empty, no slabs are allocated until first node
+    NodeArena();
+
+    //Destructor for arena type
+    //Releases all slabs at once
+    ~NodeArena();
+
+    //Function to copy node into next free arena slot and return its index
+    unsigned int allocate(const LLNode &newNode);
+
+    //Function to hand out block of consecutive nodes and return first index
+    unsigned int reserveNodes(unsigned int blockSize);
+
+    //Function to allocate one more slab
+    void addSlab();
+
+    //Function to find node stored at arena index
+    inline LLNode &getNode(unsigned int nodeIndex);
+
+    //Function to release all slabs and reset arena to empty
+    void clear();
+
+    //Function to point slabs at consecutive nodes owned by caller
+    void attachNodes(LLNode *nodeData, unsigned int nodeCount);
+};
+
+class HashLL
+{   
+    public:
+
+    //Arena index of start of linked list
+    unsigned int headPtr;
+
+    //Constructor for linked list type
+    //Sets headPtr to NULL_NODE
+    HashLL();
+
+    //Function to append node to end of linked list
+    unsigned int insert(NodeArena &nodeArena, const LLNode &newNode);
+
+    //Function to clear linked list
+    //(Nodes are released with their arena)
+    void clearList();
+
+    //Function to search for matching value in linked list
+    LLNode *search(NodeArena &nodeArena, unsigned int searchVal);
+
+    //Function to search for matching index and identifier values in linked list
+    LLNode *search(NodeArena &nodeArena, unsigned int indexVal, unsigned int searchVal);
+};
+
+class IndexHeader
+{
+    public:
+
+    //Marks file as query index, also catches files written with other byte order
+    unsigned long long magicNumber;
+
+    //Layout version, bumped whenever file layout changes
+    unsigned int formatVersion;
+
+    //Size of one node and one list head when file was written
+    unsigned int nodeBytes;
+    unsigned int headBytes;
+
+    //Number of list heads (always a power of two)
+    unsigned int hashTableSize;
+
+    //Number of queries and nodes stored
+    unsigned int numQueries;
+    unsigned int numNodes;
+
+    //Number of queries skipped for characters outside NATCG when table was built
+    unsigned int numInvalid;
+
+    //Nonzero when table holds canonical keys of both strands
+    unsigned int canonicalKeys;
+
+    //Byte offsets of list heads and nodes from start of file
+    unsigned long long headOffset;
+    unsigned long long nodeOffset;
+
+    //Checksum of list heads and nodes
+    unsigned long long payloadChecksum;
+};
+
+class KmerEncoder
+{
+    public:
+
+    //Base-5 radix value of current window (first character is lowest digit)
+    unsigned long long windowKey;
+
+    //Base-5 place value of last character in window
+    unsigned long long lastPlaceValue;
+
+    //Number of characters at end of window since last character outside NATCG
+    unsigned int validRun;
+
+    //Widest encoding kernel supported by this CPU (0 scalar, 1 SSE2, 2 AVX2)
+    unsigned int simdLevel;
+
+    //Flag for keys being smaller of forward and reverse complement radix values
+    bool canonicalFlag;
+
+    //Radix value of reverse complement of current window (kept by rollCanonical only)
+    unsigned long long reverseKey;
+
+    //Default Constructor for encoder type
+    //Sets window key to zero, computes last place value and picks kernel
+    KmerEncoder();
+
+    //Function to encode full window starting at provided index
+    unsigned long long startWindow(const char *sequence, unsigned long long index);
+
+    //Function to slide window forward by one character
+    unsigned long long rollWindow(char nextChar);
+
+    //Function to slide window forward by one base-5 digit
+    unsigned long long rollDigit(unsigned int nextDigit);
+
+    //Function to slide forward and reverse complement windows by one base-5 digit
+    //Returns smaller of the two radix values
+    unsigned long long rollCanonical(unsigned int nextDigit);
+
+    //Function to find radix value of reverse complement of 16 character radix value
+    unsigned long long reverseComplement(unsigned long long windowKey);
+
+    //Function to find key stored in tables for radix value
+    //Radix value is returned unchanged unless canonicalFlag is set
+    unsigned long long canonicalKey(unsigned long long windowKey);
+
+    //Function to check current window holds only NATCG characters
+    bool windowValid();
+
+    //Function to convert single character to base-5 value
+    //Returns INVALID_BASE for characters outside NATCG
+    unsigned int encodeBase(char baseChar);
+
+    //Function to convert block of characters to base-5 digits
+    //Returns number of characters outside NATCG (stored as INVALID_BASE)
+    unsigned int encodeBlock(const char *sequence, unsigned char *digitBuffer, unsigned int length);
+
+    //Function to write 16 characters of radix value into destBuffer
+    void decodeKey(unsigned long long windowKey, char *destBuffer);
+
+    //Function to encode 16 characters into radix value without changing window
+    //Characters outside NATCG count as N and clear validFlag
+    unsigned long long encodeWindow(const char *sequence, unsigned long long index, bool &validFlag);
+
+    //Scalar kernel for encodeBlock
+    unsigned int encodeBlockScalar(const char *sequence, unsigned char *digitBuffer, unsigned int length);
+
+#ifdef X86_SIMD
+    //SSE2 kernel for encodeBlock, 16 characters per instruction
+    unsigned int encodeBlockSSE2(const char *sequence, unsigned char *digitBuffer, unsigned int length);
+
+    //AVX2 kernel for encodeBlock, 32 characters per instruction
+    __attribute__((target("avx2")))
+    unsigned int encodeBlockAVX2(const char *sequence, unsigned char *digitBuffer, unsigned int length);
+
+    //AVX2 kernel for encodeWindow, combines all 16 digits with multiply-add
+    __attribute__((target("avx2")))
+    unsigned long long encodeWindowAVX2(const char *sequence, bool &validFlag);
+#endif
+};
+
+class BloomFilter
+{
+    public:
+
+    //Array of 512-bit blocks, one cache line each
+    //Every bit of a key is set in the same block
+    unsigned long long *blockArray;
+
+    //Number of blocks in block array (always a power of two)
+    unsigned int numBlocks;
+
+    //Number of hash bits used to pick block
+    unsigned int blockBits;
+
+    //Number of bits set per key
+    unsigned int numHashes;
+
+    //Initialization Constructor for filter type
+    //Sizes filter for numKeys keys at requested false positive rate
+    BloomFilter(unsigned int numKeys, double falsePositiveRate);
+
+    //Destructor for filter type
+    //Deallocates block array
+    ~BloomFilter();
+
+    //Function to set bits of key
+    void addKey(unsigned long long key);
+
+    //Function to set bits of key when other threads may share its block
+    void addKeyShared(unsigned long long key);
+
+    //Function to check key might be in filter
+    //Returns false only for keys never added
+    bool mayContain(unsigned long long key);
+
+    //Function to find number of bytes used by filter
+    unsigned long long memoryUsage();
+};
+
+class PerfCounters
+{
+    public:
+
+    //Set once at start of program, turns counting on for every phase and scan thread
+    static bool countingFlag;
+
+    //File descriptor of each counter (-1 when counter could not be opened)
+    int counterFds[NUM_COUNTERS];
+
+    //Counts in order cycles, instructions, LLC misses, dTLB misses, branch misses
+    //Scaled up when kernel had to share hardware counters between events
+    unsigned long long counterValues[NUM_COUNTERS];
+
+    //Bit set for each counter that could be opened, zero means wall-clock time only
+    unsigned int openedMask;
+
+    //Wall-clock time counted so far in microseconds
+    long long wallUSec;
+
+    //Wall-clock time of last start
+    struct timeval startTime;
+
+    //Default Constructor for counter type
+    //Sets every count to zero, no counter is open
+    PerfCounters();
+
+    //Function to open and start counters for calling thread
+    //Counters also follow threads started afterwards, so phases include worker threads
+    void startCounters(bool inheritFlag);
+
+    //Function to stop, read and close counters, adding to counts
+    void stopCounters();
+
+    //Function to add counts of other counters
+    void addCounters(const PerfCounters &otherCounters);
+
+    //Function to print counts and rates for one phase or thread
+    void printCounters(std::ostream &outputStream, const char *phaseName);
+};
+
+class ScanResult
+{
+    public:
+
+    //Number of matching windows found
+    unsigned long long numMatches;
+
+    //Number of windows scanned
+    unsigned long long numWindows;
+
+    //Number of windows rejected by prefilter without probing table
+    unsigned long long prefilterRejects;
+
+    //Number of windows passed by prefilter and probed in table
+    unsigned long long prefilterPasses;
+
+    //Set once at start of program, keeps every match instead of first MAX_PRINTED_MATCHES
+    //Off unless matches are reported, so memory does not grow with number of matches
+    static bool keepAllFlag;
+
+    //Genome index of each kept matching window, in genome order
+    std::vector<unsigned long long> matchPositions;
+
+    //Radix value of each kept matching window, same order as matchPositions
+    std::vector<unsigned long long> matchKeys;
+
+    //Counters of range scanned by one thread
+    PerfCounters rangeCounters;
+
+    //Counters of each scan thread, summed over chunks when genome is streamed
+    std::vector<PerfCounters> threadCounters;
+
+    //Default Constructor for result type
+    //Sets number of matches to zero
+    ScanResult();
+
+    //Function to count match, keeping its position and key while there is room
+    void addMatch(unsigned long long matchPosition, unsigned long long matchKey);
+
+    //Function to append results of following genome range
+    void mergeResult(const ScanResult &nextResult);
+
+    //Function to drop kept matches past first keepCount
+    void trimMatches(unsigned long long keepCount);
+};
+
+class FastaReader
+{
+    public:
+
+    //Buffer of sequence characters with headers and newlines removed
+    char *sequenceBuffer;
+
+    //Number of bytes allocated for sequence buffer
+    unsigned long long bufferBytes;
+
+    //Number of characters in sequence buffer
+    unsigned long long sequenceLength;
+
+    //Start of file contents, either mapped or read into memory
+    char *fileData;
+
+    //Number of bytes in file contents
+    unsigned long long fileLength;
+
+    //Flag for file contents mapped rather than read
+    bool mappedFlag;
+
+    //Raw file bytes read but not yet handed out by readChunk
+    char *streamBuffer;
+    unsigned int streamIndex;
+    unsigned int streamLength;
+
+    //Flags for readChunk stopping inside header line, inside record name or at start of line
+    bool headerFlag;
+    bool nameFlag;
+    bool lineStartFlag;
+
+    //Number of characters handed out by readChunk so far
+    unsigned long long streamPosition;
+
+    //Sequence index where each record begins, in file order
+    //Records are split by RECORD_SEPARATOR so no window spans two records
+    std::vector<unsigned long long> recordStarts;
+
+    //Name of each record, taken from its header line up to first space
+    std::vector<std::string> recordNames;
+
+    //Record index of each query kept by readQueries
+    std::vector<unsigned int> queryRecords;
+
+    //Default Constructor for reader type
+    //Sets reader to empty
+    FastaReader();
+
+    //Destructor for reader type
+    //Deallocates sequence buffer and releases file contents
+    ~FastaReader();
+
+    //Function to copy every sequence character of file into sequence buffer
+    //Header lines beginning with '>' and non-alphabet characters are skipped
+    bool readFile(FILE *filePointer);
+
+    //Function to read file and keep only whole queries of queryLength characters
+    //Leftover characters at end of each record are dropped
+    bool readQueries(FILE *filePointer, unsigned int queryLength);
+
+    //Function to start new record at buffer index, returns buffer index of its first character
+    //Separator is written first when an earlier record has characters
+    //Dependency: scanFile, readChunk
+    unsigned long long startRecord(char *destBuffer, unsigned long long seqIndex, unsigned long long seqOffset,
+                                    const char *nameStart, const char *nameEnd);
+
+    //Function to give any sequence before first header its own unnamed record
+    void finishRecords();
+
+    //Function to find record holding sequence index
+    unsigned int findRecord(unsigned long long seqIndex);
+
+    //Function to count sequence characters of file without copying them
+    unsigned long long countFile(FILE *filePointer);
+
+    //Function to map file contents, falls back to reading whole file
+    bool openFile(FILE *filePointer);
+
+    //Function to release file contents
+    void closeFile();
+
+    //Function to copy next maxLength sequence characters of file into destBuffer
+    //Reads file front to back in fixed blocks, returns less than maxLength only at end of file
+    unsigned long long readChunk(FILE *filePointer, char *destBuffer, unsigned long long maxLength);
+
+    //Function to scan file contents line by line
+    //Copies sequence characters into destBuffer when not NULL
+    unsigned long long scanFile(char *destBuffer);
+};
+
+class QueryCatalog
+{
+    public:
+
+    //Radix value of every valid query, sorted
+    std::vector<unsigned long long> keyArray;
+
+    //Query record of each radix value in keyArray
+    std::vector<unsigned int> recordArray;
+
+    //Name of each query record
+    std::vector<std::string> recordNames;
+
+    //Function to read and encode every query of file
+    void readCatalog(FILE *queryFile);
+
+    //Function to find first query record holding radix value
+    //Returns INVALID_QUERY when radix value is not a query
+    unsigned int findQuery(unsigned long long queryKey);
+};
+
+class LookupProbe
+{
+    public:
+
+    //Position of key in batch, result is written there
+    unsigned int keyIndex;
+
+    //First 12 characters of key in radix form and last 4 as identifier
+    unsigned int indexValue;
+    unsigned int radixValue;
+
+    //Arena index of node being loaded, or list head index while at PROBE_HEAD
+    unsigned int nodeIndex;
+
+    //Load probe waits on, PROBE_HEAD or PROBE_NODE
+    unsigned int probeStage;
+};
+
+class TableStats
+{
+    public:
+
+    //Number of list heads and number holding at least one node
+    unsigned long long numBuckets;
+    unsigned long long usedBuckets;
+
+    //Number of queries stored and bytes used by table
+    unsigned long long numQueries;
+    unsigned long long tableBytes;
+
+    //Number of nodes in longest list
+    unsigned long long longestChain;
+
+    //Number of lists of each length, last bin holds every longer list
+    std::vector<unsigned long long> chainHistogram;
+
+    //Windows looked up in table, nodes visited by those lookups and lookups that matched
+    //Filled by Queries_HT::probeGenome
+    unsigned long long numLookups;
+    unsigned long long numProbes;
+    unsigned long long numHits;
+
+    //Default Constructor for stats type
+    //Sets all counts to zero
+    TableStats();
+
+    //Function to print stats in readable form
+    void printStats(std::ostream &outputStream);
+
+    //Function to write stats as one JSON object
+    bool writeJSON(const char *jsonPath);
+};
+
+class Queries_HT
+{
+    public:
+
+    //Pointer to file containing query data
+    FILE *queryFilePointer;
+
+    //Total number of queries in hash table
+    unsigned int numQueries;
+
+    //Number of indices in hash table array (always a power of two)
+    unsigned int hashTableSize;
+
+    //Largest ratio of queries to indices before hash array grows
+    double maxLoadFactor;
+
+    //Hash table array of linked list pointers
+    HashLL *hashArray;
+
+    //Arena holding every node of every linked list
+    NodeArena nodeArena;
+
+    //Number of queries skipped for characters outside NATCG
+    unsigned int numInvalid;
+
+    //Encoder used to convert queries to radix values
+    KmerEncoder queryEncoder;
+
+    //Target false positive rate of prefilter, zero leaves prefilter off
+    double prefilterRate;
+
+    //Blocked Bloom filter checked before table is probed (NULL when off)
+    BloomFilter *prefilter;
+
+    //Function to size prefilter for numKeys queries and add stored queries
+    void buildPrefilter(unsigned int numKeys);
+
+    //Default Constructor for Hash Table class
+    //Sets all class variables to default values
+    Queries_HT();
+
+    //Initialization Constructor for Hash Table class
+    //Rounds hashSize up to a power of two and initializes hash array
+    Queries_HT(FILE *queryFile, int hashSize, double loadFactor = DEFAULT_LOAD_FACTOR);
+
+    //Destructor for Hash Table class
+    //Deallocates memory from linked lists and hash array
+    //(Node arena releases all list nodes at once)
+    ~Queries_HT();
+
+    //Function to search hash array for matching values
+    bool searchHash(char *searchValue, unsigned int srcIndex);
+
+    //Function to search hash array using precomputed window key
+    bool searchKey(unsigned long long windowKey);
+
+    //Function to start loading list head of window key into cache
+    void prefetchKey(unsigned long long windowKey);
+
+    //Function to search batch of window keys with up to INTERLEAVE_WIDTH lookups in flight
+    //Each lookup prefetches its next list node and steps aside until load is done
+    //Gives same results as searchKey, which stays reference path
+    void searchInterleaved(const unsigned long long *batchKeys, unsigned int numKeys, bool *batchResults);
+
+    //Function to insert new sequence into hash table
+    unsigned int insertSequence(char *newValue);
+
+    //Function to convert character fragments into base-10 integer
+    //Returns INVALID_QUERY when fragment holds a character outside NATCG
+    unsigned int convertToRadix(char *originalString, unsigned int index, unsigned int length);
+
+    //Function to fill hash array using query data
+    unsigned int fillHashes(bool timerFlag);
+
+    //Function to fill hash array using query data on several threads
+    //Queries are split into shards by hash index so no locking is needed
+    unsigned int fillHashes(bool timerFlag, unsigned int numThreads);
+
+    //Function to encode chunk of queries and count queries per shard
+    //Dependency: fillHashes (parallel)
+    void encodeChunk(const char *sequenceBuffer, unsigned int firstQuery, unsigned int lastQuery,
+                        unsigned int shardShift, unsigned int *indexValues, unsigned int *radixValues,
+                        unsigned int *shardCounts);
+
+    //Function to copy chunk of encoded queries into their shard's arena block
+    //Dependency: fillHashes (parallel)
+    void scatterChunk(const char *sequenceBuffer, unsigned int firstQuery, unsigned int lastQuery,
+                        unsigned int shardShift, const unsigned int *indexValues,
+                        const unsigned int *radixValues, unsigned int *shardOffsets);
+
+    //Function to link every node of a set of shards into its linked list
+    //Dependency: fillHashes (parallel)
+    void linkShards(unsigned int firstShard, unsigned int shardStep, unsigned int numShards,
+                        const unsigned int *shardStarts, unsigned int *numCollisions);
+
+    //Function to find number of bytes used by hash table
+    unsigned long long memoryUsage();
+
+    //Function to measure list lengths and occupancy of hash array
+    void collectStats(TableStats &tableStats);
+
+    //Function to look up every genome window, counting nodes visited and hits
+    //Separate from timed scan so counting never slows it down
+    void probeGenome(const char *genomeString, unsigned long long numSubstrings, TableStats &tableStats);
+
+    //Function to double hash array size and relink all nodes
+    void growTable();
+
+    //Start of mapped index file backing hash array and nodes (NULL when built in memory)
+    void *indexMapping;
+
+    //Number of bytes in mapped index file
+    unsigned long long indexLength;
+
+    //Function to save built table as versioned, checksummed index file
+    bool writeIndex(const char *indexPath);
+
+    //Function to map index file and use it as hash array and nodes without copying
+    //Checksum reads every page, so trusted files may skip it by clearing verifyFlag
+    //Loaded tables are read only
+    bool loadIndex(const char *indexPath, bool verifyFlag);
+
+    private:
+
+    //Function to find hash index for insertion/searching
+    //Dependency: convertToRadix
+    unsigned int findHashIndex(char *valueString, unsigned int index, unsigned int length);
+};
+
+class Queries_FlatHT
+{
+    public:
+
+    //Pointer to file containing query data
+    FILE *queryFilePointer;
+
+    //Total number of distinct queries in hash table
+    unsigned int numQueries;
+
+    //Number of slots in hash table array (always a power of two)
+    unsigned int hashTableSize;
+
+    //Number of hash bits used to find home slot
+    unsigned int hashBits;
+
+    //Largest ratio of queries to slots before slot array grows
+    double maxLoadFactor;
+
+    //Hash table array of full 16 character radix values
+    //Empty slots hold EMPTY_SLOT
+    unsigned long long *slotArray;
+
+    //Number of queries skipped for characters outside NATCG
+    unsigned int numInvalid;
+
+    //Encoder used to convert queries to radix values
+    KmerEncoder queryEncoder;
+
+    //Target false positive rate of prefilter, zero leaves prefilter off
+    double prefilterRate;
+
+    //Blocked Bloom filter checked before table is probed (NULL when off)
+    BloomFilter *prefilter;
+
+    //Function to size prefilter for numKeys queries and add stored queries
+    void buildPrefilter(unsigned int numKeys);
+
+    //Default Constructor for Flat Hash Table class
+    //Sets all class variables to default values
+    Queries_FlatHT();
+
+    //Initialization Constructor for Flat Hash Table class
+    //Rounds hashSize up to a power of two and empties all slots
+    Queries_FlatHT(FILE *queryFile, int hashSize, double loadFactor = DEFAULT_LOAD_FACTOR);
+
+    //Destructor for Flat Hash Table class
+    //Deallocates slot array
+    ~Queries_FlatHT();
+
+    //Function to search slot array for matching values
+    bool searchHash(char *searchValue, unsigned int srcIndex);
+
+    //Function to search slot array using precomputed window key
+    bool searchKey(unsigned long long windowKey);
+
+    //Function to start loading home slot of window key into cache
+    void prefetchKey(unsigned long long windowKey);
+
+    //Function to insert new sequence into hash table
+    unsigned int insertSequence(char *newValue);
+
+    //Function to insert precomputed key into hash table
+    unsigned int insertKey(unsigned long long newKey);
+
+    //Function to fill slot array using query data
+    unsigned int fillHashes(bool timerFlag);
+
+    //Function to find number of bytes used by hash table
+    unsigned long long memoryUsage();
+
+    //Function to double slot array size and reinsert all keys
+    void growTable();
+
+    //Function to find home slot for insertion/searching
+    unsigned int findSlotIndex(unsigned long long key);
+};
+
+class Queries_Sorted
+{
+    public:
+
+    //Pointer to file containing query data
+    FILE *queryFilePointer;
+
+    //Total number of distinct queries in array
+    unsigned int numQueries;
+
+    //Array of distinct 16 character radix values in Eytzinger order
+    //Index 0 is unused, children of index k are 2k and 2k+1
+    unsigned long long *keyArray;
+
+    //Number of queries skipped for characters outside NATCG
+    unsigned int numInvalid;
+
+    //Encoder used to convert queries to radix values
+    KmerEncoder queryEncoder;
+
+    //Target false positive rate of prefilter, zero leaves prefilter off
+    double prefilterRate;
+
+    //Blocked Bloom filter checked before array is searched (NULL when off)
+    BloomFilter *prefilter;
+
+    //Default Constructor for Sorted Array class
+    //Sets all class variables to default values
+    Queries_Sorted();
+
+    //Initialization Constructor for Sorted Array class
+    //Array is built by fillHashes
+    Queries_Sorted(FILE *queryFile);
+
+    //Destructor for Sorted Array class
+    //Deallocates key array and prefilter
+    ~Queries_Sorted();
+
+    //Function to search key array for matching values
+    bool searchHash(char *searchValue, unsigned int srcIndex);
+
+    //Function to search key array using precomputed window key
+    bool searchKey(unsigned long long windowKey);
+
+    //Function to start loading data for window key into cache
+    //Top levels of array stay in cache, search prefetches lower levels itself
+    void prefetchKey(unsigned long long windowKey);
+
+    //Function to sort, deduplicate and lay out query data
+    //Returns number of duplicate queries removed
+    unsigned int fillHashes(bool timerFlag);
+
+    //Function to lay out sorted keys in Eytzinger order
+    //Dependency: fillHashes
+    unsigned int layoutKeys(const unsigned long long *sortedKeys, unsigned int sortedIndex, unsigned int arrayIndex);
+
+    //Function to find number of bytes used by key array
+    unsigned long long memoryUsage();
+};
+
+class Queries_Approx
+{
+    public:
+
+    //Pointer to file containing query data
+    FILE *queryFilePointer;
+
+    //Total number of distinct queries in index
+    unsigned int numQueries;
+
+    //Number of queries skipped for characters outside NATCG
+    unsigned int numInvalid;
+
+    //Start of each bucket in firstKeys, indexed by radix value of first 8 characters
+    //A query within one substitution of a window matches it exactly in one half
+    unsigned int *firstStarts;
+
+    //Radix values of queries grouped by first 8 characters
+    unsigned long long *firstKeys;
+
+    //Start of each bucket in lastKeys, indexed by radix value of last 8 characters
+    unsigned int *lastStarts;
+
+    //Radix values of queries grouped by last 8 characters
+    unsigned long long *lastKeys;
+
+    //Encoder used to convert queries to radix values
+    KmerEncoder queryEncoder;
+
+    //A Bloom filter of exact keys cannot reject near matches, so prefilter is never built (always NULL)
+    BloomFilter *prefilter;
+
+    //Default Constructor for approximate index class
+    //Sets all class variables to default values
+    Queries_Approx();
+
+    //Initialization Constructor for approximate index class
+    //Index is built by fillHashes
+    Queries_Approx(FILE *queryFile);
+
+    //Destructor for approximate index class
+    //Deallocates bucket and key arrays
+    ~Queries_Approx();
+
+    //Function to check 16 characters are within one substitution of a query
+    bool searchHash(char *searchValue, unsigned int srcIndex);
+
+    //Function to check window key is within one substitution of a query
+    bool searchKey(unsigned long long windowKey);
+
+    //Function to start loading both bucket starts of window key into cache
+    void prefetchKey(unsigned long long windowKey);
+
+    //Function to find query within one substitution of window key
+    //Returns EMPTY_SLOT when no query is close enough
+    unsigned long long findNeighbour(unsigned long long windowKey);
+
+    //Function to read, deduplicate and bucket query data by both halves
+    //Returns number of duplicate queries removed
+    unsigned int fillHashes(bool timerFlag);
+
+    //Function to find number of bytes used by index
+    unsigned long long memoryUsage();
+};
+
+class Queries_Perfect
+{
+    public:
+
+    //Pointer to file containing query data
+    FILE *queryFilePointer;
+
+    //Total number of distinct queries in index
+    unsigned int numQueries;
+
+    //Number of queries skipped for characters outside NATCG
+    unsigned int numInvalid;
+
+    //Number of buckets queries are hashed into, about PERFECT_BUCKET_KEYS queries each
+    unsigned int numBuckets;
+
+    //Number of slots pilots place queries into, numQueries / PERFECT_FILL
+    unsigned int numSlots;
+
+    //Pilot of each bucket, moves every query of bucket to its own free slot
+    unsigned short *pilotValues;
+
+    //Index below numQueries for each slot at or above numQueries, keeps hash minimal
+    std::vector<unsigned int> remapSlots;
+
+    //Radix value of each query at its perfect hash index, PACKED_KEY_BYTES bytes each
+    //Radix values are below 5^16 < 2^40, so five bytes hold a whole key
+    unsigned char *packedKeys;
+
+    //Sorted queries of buckets no pilot could place, searched by binary search
+    std::vector<unsigned long long> fallbackKeys;
+
+    //Encoder used to convert queries to radix values
+    KmerEncoder queryEncoder;
+
+    //Target false positive rate of prefilter, zero leaves prefilter off
+    double prefilterRate;
+
+    //Blocked Bloom filter checked before index is searched (NULL when off)
+    BloomFilter *prefilter;
+
+    //Default Constructor for perfect hash class
+    //Sets all class variables to default values
+    Queries_Perfect();
+
+    //Initialization Constructor for perfect hash class
+    //Index is built by fillHashes
+    Queries_Perfect(FILE *queryFile);
+
+    //Destructor for perfect hash class
+    //Deallocates pilot and key arrays
+    ~Queries_Perfect();
+
+    //Function to search index for 16 matching characters
+    bool searchHash(char *searchValue, unsigned int srcIndex);
+
+    //Function to search index using precomputed window key
+    //One pilot read, then one key compare at the slot it gives
+    bool searchKey(unsigned long long windowKey);
+
+    //Function to start loading stored key at window key's index into cache
+    void prefetchKey(unsigned long long windowKey);
+
+    //Function to find perfect hash index of key, below numQueries for every key
+    //Keys not in query set get some index too, caller must compare key stored there
+    unsigned int findIndex(unsigned long long windowKey);
+
+    //Function to read and deduplicate queries and search pilots
+    //Returns number of duplicate queries removed
+    unsigned int fillHashes(bool timerFlag);
+
+    //Function to find number of bits per query used by pilots and remapped slots alone
+    double hashBitsPerKey();
+
+    //Function to find number of bytes used by index
+    unsigned long long memoryUsage();
+
+    private:
+
+    //Function to mix key with seed and scale result below given range
+    //Dependency: findIndex, fillHashes
+    unsigned int mixRange(unsigned long long windowKey, unsigned long long seedValue, unsigned int rangeSize);
+
+    //Function to find slot of key for given pilot before remapping
+    //Dependency: findIndex, fillHashes
+    unsigned int pilotSlot(unsigned long long windowKey, unsigned int pilotValue);
+};
+
+class Queries_Bitmap
+{
+    public:
+
+    //Pointer to file containing query data
+    FILE *queryFilePointer;
+
+    //Total number of distinct queries in index
+    unsigned int numQueries;
+
+    //Number of queries skipped for characters outside NATCG
+    unsigned int numInvalid;
+
+    //One bit for every 16 character ACGT string, 2 bits per character
+    unsigned long long *bitWords;
+
+    //Sorted radix values of queries holding N, which 2 bits cannot encode
+    std::vector<unsigned long long> nKeys;
+
+    //2-bit code of every 4 digit block of a radix value, CHUNK_HAS_N set when block holds N
+    unsigned short chunkBits[CHUNK_VALUES];
+
+    //Encoder used to convert queries to radix values
+    KmerEncoder queryEncoder;
+
+    //Bitmap is exact, so prefilter is never built (always NULL)
+    BloomFilter *prefilter;
+
+    //Default Constructor for bitmap class
+    //Sets all class variables to default values and fills chunk codes
+    Queries_Bitmap();
+
+    //Initialization Constructor for bitmap class
+    //Bitmap is allocated by fillHashes
+    Queries_Bitmap(FILE *queryFile);
+
+    //Destructor for bitmap class
+    //Deallocates bitmap
+    ~Queries_Bitmap();
+
+    //Function to search bitmap for 16 matching characters
+    bool searchHash(char *searchValue, unsigned int srcIndex);
+
+    //Function to search bitmap using precomputed window key
+    //ACGT windows test one bit, windows holding N search nKeys
+    bool searchKey(unsigned long long windowKey);
+
+    //Function to start loading word of window key's bit into cache
+    void prefetchKey(unsigned long long windowKey);
+
+    //Function to convert radix value to bit index, clears acgtFlag when key holds N
+    unsigned long long bitIndex(unsigned long long windowKey, bool &acgtFlag);
+
+    //Function to read queries and set their bits
+    //Returns number of duplicate queries
+    unsigned int fillHashes(bool timerFlag);
+
+    //Function to find number of bytes used by index
+    unsigned long long memoryUsage();
+
+    private:
+
+    //Function to fill chunkBits
+    //Dependency: Queries_Bitmap
+    void fillChunks();
+};
+
+class MatchReport
+{
+    public:
+
+    //File every match is written to (NULL when not open)
+    FILE *reportFile;
+
+    //Number of matches written
+    unsigned long long numWritten;
+
+    //Query record of each radix value, for naming matched queries
+    QueryCatalog queryCatalog;
+
+    //Encoder used to find reverse complement of windows matched on other strand
+    //Reverse strand is only looked up when canonicalFlag is set
+    KmerEncoder reportEncoder;
+
+    //Approximate index that found matches, near matches are named after query they are close to
+    Queries_Approx *approxTable;
+
+    //Default Constructor for report type
+    //Sets report to closed
+    MatchReport();
+
+    //Destructor for report type
+    //Closes report file if still open
+    ~MatchReport();
+
+    //Function to create report file and read query names
+    //Returns false when file cannot be created
+    bool openReport(const char *reportPath, FILE *queryFile);
+
+    //Function to write every kept match as genome record, offset in record, query record and strand
+    //Records of genomeReader must already hold every match, so streamed chunks are written as they are scanned
+    void writeMatches(const ScanResult &scanResult, FastaReader &genomeReader);
+
+    //Function to close report file, returns false when file could not be written
+    bool closeReport();
+};
+
+class WorkloadGenerator
+{
+    public:
+
+    //Seed every random stream is derived from, same seed gives same files
+    unsigned long long seedValue;
+
+    //Number of genome characters and queries to write
+    unsigned long long genomeLength;
+    unsigned long long numQueries;
+
+    //Chance each query is copied from a genome window
+    double plantedFraction;
+
+    //Chance each query after first repeats an earlier query
+    double duplicateFraction;
+
+    //Average number of N runs per million genome characters and their mean length
+    double nRunRate;
+    double nRunLength;
+
+    //Counts found while writing, expectedMatches is number of genome windows equal to some query
+    unsigned long long numPlanted;
+    unsigned long long numDuplicates;
+    unsigned long long numRandom;
+    unsigned long long expectedMatches;
+
+    //Constructor for generator type
+    //Sets small default workload for given seed
+    WorkloadGenerator(unsigned long long seed);
+
+    //Function to write genome and queries as FASTA and count expected matches
+    //Needs eight bytes per query, genome is streamed and never held in memory
+    bool generate(FILE *genomeFile, FILE *queryFile);
+
+    //Function to restart genome stream from its first character
+    void resetGenome();
+
+    //Function to write next characters of genome stream into buffer
+    void fillGenome(char *destBuffer, unsigned long long length);
+
+    private:
+
+    //State of genome stream
+    unsigned long long genomeState;
+    unsigned long long baseBits;
+    unsigned int numBaseBits;
+    unsigned long long nextRunStart;
+    unsigned long long runRemaining;
+    unsigned long long genomePosition;
+
+    //Function to choose type of every query, returns number planted
+    //Dependency: generate
+    unsigned long long chooseTypes(std::vector<unsigned char> *typeArray);
+
+    //Function to find distance to next N run
+    //Dependency: fillGenome
+    unsigned long long drawGap();
+};
+
+//Query set for one k-mer length fixed at compile time
+//Bases are packed two bits each (A=0, C=1, G=2, T=3), windows holding N are never matched
+template <unsigned int KmerLength>
+class KmerTable
+{
+    public:
+
+    //Smallest key type holding two bits per base
+    typedef typename std::conditional<(KmerLength <= 16), unsigned int, unsigned long long>::type KeyType;
+
+    //Mask keeping bits of one k-mer
+    static constexpr KeyType KEY_MASK = (~(KeyType)0) >> ((8 * sizeof(KeyType)) - (2 * KmerLength));
+
+    //Total number of distinct queries in array
+    unsigned int numQueries;
+
+    //Number of queries skipped for characters outside ACGT
+    unsigned int numInvalid;
+
+    //Distinct query keys in Eytzinger order, index 0 unused
+    //Aligned to cache lines so prefetch of one line covers whole group of descendants
+    KeyType *keyArray;
+
+    //Default Constructor for k-mer table
+    //Sets all class variables to default values
+    KmerTable();
+
+    //Destructor for k-mer table
+    //Deallocates key array
+    ~KmerTable();
+
+    //Function to pack one k-mer, returns false if any base is outside ACGT
+    static bool encodeKmer(const char *sequence, KeyType &kmerKey);
+
+    //Function to read, pack, sort and deduplicate every query in file
+    //Returns number of duplicate queries removed
+    unsigned int fillKeys(FILE *queryFile);
+
+    //Function to search key array for packed k-mer
+    bool searchKey(KeyType kmerKey);
+
+    //Function to count every genome window found in key array
+    ScanResult scanGenome(const char *genomeString, unsigned long long genomeLength);
+
+    //Function to lay out sorted keys in Eytzinger order
+    //Dependency: fillKeys
+    unsigned int layoutKeys(const KeyType *sortedKeys, unsigned int sortedIndex, unsigned int arrayIndex);
+};
+
+int compareString(const char *oneStr, const char *otherStr);
+unsigned int getStringLength(const char *testStr);
+void copyString(char *destStr, const char *sourceStr);
+unsigned int countQueries(FILE *queryFile);
+void readQueryKeys(FILE *queryFile, KmerEncoder &queryEncoder, std::vector<unsigned long long> &queryKeys,
+                    unsigned int &numInvalid);
+template <class KeyType>
+unsigned int removeDuplicateKeys(std::vector<KeyType> &queryKeys);
+unsigned int collectUniqueKeys(FILE *queryFile, KmerEncoder &queryEncoder, std::vector<unsigned long long> &queryKeys,
+                    unsigned int &numInvalid);
+long long elapsedUSecs(const struct timeval &startTime, const struct timeval &endTime);
+void printElapsed(const struct timeval &startTime, const struct timeval &endTime, const char *taskName);
+unsigned int findTableSize(unsigned int numItems, double loadFactor);
+unsigned long long chainTableBytes(unsigned int numItems, double loadFactor);
+unsigned long long checksumBytes(const void *byteData, unsigned long long numBytes, unsigned long long checksum);
+unsigned int halfDistance(unsigned long long oneHalf, unsigned long long otherHalf);
+unsigned long long nextRandom(unsigned long long &randomState);
+template <class BaseTable, class TestTable>
+void timeSearchPair(BaseTable &baseTable, TestTable &testTable, const char *genomeString,
+                    unsigned long long numSubstrings, unsigned int numThreads,
+                    long long *searchUSecs, unsigned long long *searchMatches);
+void benchmarkApprox(Queries_Approx &approxTable, FILE *queryFile, const char *genomeString,
+                    unsigned long long numSubstrings, unsigned int numThreads);
+void benchmarkPerfect(Queries_Perfect &perfectTable, FILE *queryFile, const char *genomeString,
+                    unsigned long long numSubstrings, unsigned int numThreads);
+unsigned int packBase(char baseChar);
+bool dispatchKmerSearch(unsigned int kmerLength, FILE *queryFile, const char *genomeString,
+                    unsigned long long genomeLength, bool timerFlag, bool searchTimerFlag,
+                    ScanResult &scanResult);
+template <unsigned int KmerLength>
+ScanResult runKmerSearch(FILE *queryFile, const char *genomeString,
+                    unsigned long long genomeLength, bool timerFlag, bool searchTimerFlag);
+
+template <class QueryTable>
+void searchBatch(QueryTable *queryTable, const unsigned long long *batchKeys, unsigned int numKeys,
+                    bool *batchResults);
+void searchBatch(Queries_HT *queryTable, const unsigned long long *batchKeys, unsigned int numKeys,
+                    bool *batchResults);
+template <class QueryTable, bool CanonicalMode>
+void scanRange(QueryTable *queryTable, const char *genomeString, unsigned long long startIndex,
+                    unsigned long long endIndex, unsigned int batchSize, ScanResult *scanResult);
+template <class QueryTable>
+ScanResult searchGenome(QueryTable &queryTable, const char *genomeString, unsigned long long numSubstrings,
+                    unsigned int numThreads, unsigned int batchSize = DEFAULT_BATCH);
+template <class QueryTable>
+ScanResult streamGenome(QueryTable &queryTable, FILE *genomeFile, FastaReader &genomeReader,
+                    unsigned long long chunkLength, unsigned int numThreads, unsigned int batchSize = DEFAULT_BATCH,
+                    MatchReport *matchReport = NULL);
+
+HashLL::HashLL()
+{
+    //Set headPtr to NULL_NODE
+    headPtr = NULL_NODE;
+}
+
+unsigned int HashLL::insert(NodeArena &nodeArena, const LLNode &newNode)
+{
+    //Copy node into arena
+    unsigned int newIndex = nodeArena.allocate(newNode);
+
+    //Check for list empty
+    if(headPtr == NULL_NODE)
+    {
+        //Set head to new node
+        headPtr = newIndex;
+    }
+    else
+    {
+        //Initialize working node
+        LLNode *wkgPtr = &nodeArena.getNode(headPtr);
+
+        //Loop to end of linked list
+        while(wkgPtr->nextNode != NULL_NODE)
+        {
+            wkgPtr = &nodeArena.getNode(wkgPtr->nextNode);
+        }
+        //Append new node to end of list
+        wkgPtr->nextNode = newIndex;
+
+        //Return collision detected and resolved
+        return 1u;
+    }
+
+    //Return no collision detected
+    return 0u;
+}
+
+void HashLL::clearList()
+{
+    //Detach list, node memory belongs to arena
+    headPtr = NULL_NODE;
+}
+
+LLNode* HashLL::search(NodeArena &nodeArena, unsigned int searchVal)
+{
+    //Initialize working index
+    unsigned int wkgIndex = headPtr;
+
+    //Loop until match found or end of list
+    while(wkgIndex != NULL_NODE)
+    {
+        LLNode *wkgPtr = &nodeArena.getNode(wkgIndex);
+
+        //Check for matching value
+        if(searchVal == wkgPtr->radixValue)
+        {
+            //Return pointer to matching node
+            return wkgPtr;
+        }
+        //Move to next node
+        wkgIndex = wkgPtr->nextNode;
+    }
+    //No match found, return NULL
+    return NULL;
+}
+
+LLNode* HashLL::search(NodeArena &nodeArena, unsigned int indexVal, unsigned int searchVal)
+{
+    //Initialize working index
+    unsigned int wkgIndex = headPtr;
+
+    //Loop until match found or end of list
+    while(wkgIndex != NULL_NODE)
+    {
+        LLNode *wkgPtr = &nodeArena.getNode(wkgIndex);
+
+        //Check for matching values, bucket may hold several index values
+        if(searchVal == wkgPtr->radixValue && indexVal == wkgPtr->indexValue)
+        {
+            //Return pointer to matching node
+            return wkgPtr;
+        }
+        //Move to next node
+        wkgIndex = wkgPtr->nextNode;
+    }
+    //No match found, return NULL
+    return NULL;
+}
+
+LLNode::LLNode()
+{
+    //Set all values to default
+    querySequence[0] = '\0';
+    radixValue = 0;
+    indexValue = 0;
+    nextNode = NULL_NODE;
+}
+
+LLNode::LLNode(const char* sequence, unsigned int value)
+{
+    //Set all values to provided data
+    copyString(querySequence, sequence);
+    radixValue = value;
+    indexValue = 0;
+    nextNode = NULL_NODE;
+}
+
+LLNode::LLNode(const char* sequence, unsigned int index, unsigned int value)
+{
+    //Set all values to provided data
+    copyString(querySequence, sequence);
+    radixValue = value;
+    indexValue = index;
+    nextNode = NULL_NODE;
+}
+
+NodeArena::NodeArena()
+{
+    //Set arena to empty
+    slabArray = NULL;
+    numSlabs = 0;
+    slabCapacity = 0;
+    numNodes = 0;
+    mappedFlag = false;
+}
+
+NodeArena::~NodeArena()
+{
+    //Release every slab
+    clear();
+}
+
+unsigned int NodeArena::allocate(const LLNode &newNode)
+{
+    //Check for current slab full
+    if(numNodes == numSlabs * SLAB_NODES)
+    {
+        addSlab();
+    }
+
+    //Copy node into next free slot and return its index
+    unsigned int newIndex = numNodes;
+    getNode(newIndex) = newNode;
+    numNodes++;
+    return newIndex;
+}
+
+unsigned int NodeArena::reserveNodes(unsigned int blockSize)
+{
+    //Allocate slabs until whole block fits
+    while(numNodes + blockSize > numSlabs * SLAB_NODES)
+    {
+        addSlab();
+    }
+
+    //Hand out block starting at next free slot
+    unsigned int firstIndex = numNodes;
+    numNodes += blockSize;
+    return firstIndex;
+}
+
+void NodeArena::addSlab()
+{
+    //Grow slab pointer array when out of room
+    if(numSlabs == slabCapacity)
+    {
+        unsigned int newCapacity = (slabCapacity == 0) ? 8 : slabCapacity * 2;
+        LLNode **newArray = new LLNode*[newCapacity];
+        for(unsigned int index = 0; index < numSlabs; index++)
+        {
+            newArray[index] = slabArray[index];
+        }
+        delete[] slabArray;
+        slabArray = newArray;
+        slabCapacity = newCapacity;
+    }
+
+    //Allocate new slab for next SLAB_NODES nodes
+    slabArray[numSlabs] = new LLNode[SLAB_NODES];
+    numSlabs++;
+}
+
+inline LLNode &NodeArena::getNode(unsigned int nodeIndex)
+{
+    //Upper bits pick slab, lower bits pick node within slab
+    return slabArray[nodeIndex >> SLAB_BITS][nodeIndex & (SLAB_NODES - 1)];
+}
+
+void NodeArena::clear()
+{
+    //Release whole slabs, nodes are not freed one at a time
+    //Attached slabs belong to caller
+    for(unsigned int index = 0; index < numSlabs && !mappedFlag; index++)
+    {
+        delete[] slabArray[index];
+    }
+    delete[] slabArray;
+
+    //Reset arena to empty
+    slabArray = NULL;
+    numSlabs = 0;
+    slabCapacity = 0;
+    numNodes = 0;
+    mappedFlag = false;
+}
+
+void NodeArena::attachNodes(LLNode *nodeData, unsigned int nodeCount)
+{
+    //Release anything held before
+    clear();
+
+    //Each slab pointer covers next SLAB_NODES nodes of caller's array
+    numSlabs = (nodeCount + SLAB_NODES - 1) / SLAB_NODES;
+    slabCapacity = numSlabs;
+    slabArray = (numSlabs > 0) ? new LLNode*[numSlabs] : NULL;
+    for(unsigned int index = 0; index < numSlabs; index++)
+    {
+        slabArray[index] = nodeData + ((unsigned long long)index * SLAB_NODES);
+    }
+    numNodes = nodeCount;
+    mappedFlag = true;
+}
+
+KmerEncoder::KmerEncoder()
+{
+    //Set window to empty and find place value of last character
+    windowKey = 0;
+    reverseKey = 0;
+    canonicalFlag = false;
+    validRun = 0;
+    lastPlaceValue = 1;
+    for(unsigned int index = 1; index < QUERY_LENGTH; index++)
+    {
+        lastPlaceValue *= 5;
+    }
+
+    //Pick widest kernel this CPU can run
+    simdLevel = 0;
+#ifdef X86_SIMD
+    simdLevel = 1;
+    if(__builtin_cpu_supports("avx2"))
+    {
+        simdLevel = 2;
+    }
+#endif
+}
+
+unsigned long long KmerEncoder::startWindow(const char *sequence, unsigned long long index)
+{
+    //Encode every character in window from scratch
+    bool validFlag = true;
+    windowKey = encodeWindow(sequence, index, validFlag);
+    validRun = validFlag ? QUERY_LENGTH : 0;
+
+    //Return radix value of window
+    return windowKey;
+}
+
+unsigned long long KmerEncoder::rollWindow(char nextChar)
+{
+    //Slide window using digit of new character
+    return rollDigit(encodeBase(nextChar));
+}
+
+unsigned long long KmerEncoder::rollDigit(unsigned int nextDigit)
+{
+    //Characters outside NATCG restart valid run and count as N
+    if(nextDigit == INVALID_BASE)
+    {
+        validRun = 0;
+        nextDigit = 0;
+    }
+    else
+    {
+        validRun++;
+    }
+
+    //Drop first character by shifting every digit down one place
+    //Add new character as last digit of window
+    windowKey = (windowKey / 5) + (nextDigit * lastPlaceValue);
+
+    //Return radix value of window
+    return windowKey;
+}
+
+unsigned long long KmerEncoder::rollCanonical(unsigned int nextDigit)
+{
+    //Complement swaps A with T and C with G, N and bad characters stay 0
+    static const unsigned char complementDigit[5] = {0, 2, 1, 4, 3};
+    unsigned int reverseDigit = (nextDigit == INVALID_BASE) ? 0 : complementDigit[nextDigit];
+
+    //New character is first digit of reverse complement, drop its last digit
+    reverseKey = ((reverseKey % lastPlaceValue) * 5) + reverseDigit;
+    rollDigit(nextDigit);
+
+    //Return smaller of both strands
+    return (reverseKey < windowKey) ? reverseKey : windowKey;
+}
+
+unsigned long long KmerEncoder::reverseComplement(unsigned long long windowKey)
+{
+    //Read digits lowest first, write them complemented highest first
+    static const unsigned char complementDigit[5] = {0, 2, 1, 4, 3};
+    unsigned long long reverseValue = 0;
+    for(unsigned int index = 0; index < QUERY_LENGTH; index++)
+    {
+        reverseValue = (reverseValue * 5) + complementDigit[windowKey % 5];
+        windowKey /= 5;
+    }
+    return reverseValue;
+}
+
+unsigned long long KmerEncoder::canonicalKey(unsigned long long windowKey)
+{
+    //Forward only unless both strands are searched
+    if(!canonicalFlag)
+    {
+        return windowKey;
+    }
+    unsigned long long reverseValue = reverseComplement(windowKey);
+    return (reverseValue < windowKey) ? reverseValue : windowKey;
+}
+
+bool KmerEncoder::windowValid()
+{
+    //Window is valid once a full window has passed since last bad character
+    return validRun >= QUERY_LENGTH;
+}
+
+unsigned int KmerEncoder::encodeBase(char baseChar)
+{
+    //Check provided character and return base-5 value
+    switch(baseChar)
+    {
+        case 'N':
+            return 0u;
+        case 'A':
+            return 1u;
+        case 'T':
+            return 2u;
+        case 'C':
+            return 3u;
+        case 'G':
+            return 4u;
+    }
+    return INVALID_BASE;
+}
+
+void KmerEncoder::decodeKey(unsigned long long windowKey, char *destBuffer)
+{
+    //First character is lowest digit
+    for(unsigned int index = 0; index < QUERY_LENGTH; index++)
+    {
+        destBuffer[index] = "NATCG"[windowKey % 5];
+        windowKey /= 5;
+    }
+    destBuffer[QUERY_LENGTH] = '\0';
+}
+
+unsigned int KmerEncoder::encodeBlock(const char *sequence, unsigned char *digitBuffer, unsigned int length)
+{
+    //Run widest kernel available
+#ifdef X86_SIMD
+    if(simdLevel == 2)
+    {
+        return encodeBlockAVX2(sequence, digitBuffer, length);
+    }
+    if(simdLevel == 1)
+    {
+        return encodeBlockSSE2(sequence, digitBuffer, length);
+    }
+#endif
+    return encodeBlockScalar(sequence, digitBuffer, length);
+}
+
+unsigned long long KmerEncoder::encodeWindow(const char *sequence, unsigned long long index, bool &validFlag)
+{
+    //Initialize function/variables
+    unsigned char digitBuffer[QUERY_LENGTH];
+    unsigned long long radixValue = 0;
+
+#ifdef X86_SIMD
+    if(simdLevel == 2)
+    {
+        return encodeWindowAVX2(sequence + index, validFlag);
+    }
+#endif
+
+    //Convert characters to digits, then combine from last digit to first
+    validFlag = (encodeBlock(sequence + index, digitBuffer, QUERY_LENGTH) == 0);
+    for(unsigned int counter = QUERY_LENGTH; counter > 0; counter--)
+    {
+        unsigned int digit = digitBuffer[counter - 1];
+        radixValue = (radixValue * 5) + ((digit == INVALID_BASE) ? 0 : digit);
+    }
+    return radixValue;
+}
+
+unsigned int KmerEncoder::encodeBlockScalar(const char *sequence, unsigned char *digitBuffer, unsigned int length)
+{
+    //Initialize function/variables
+    unsigned int numInvalid = 0;
+
+    //Convert one character at a time
+    for(unsigned int index = 0; index < length; index++)
+    {
+        digitBuffer[index] = (unsigned char)encodeBase(sequence[index]);
+        numInvalid += (digitBuffer[index] == INVALID_BASE);
+    }
+    return numInvalid;
+}
+
+#ifdef X86_SIMD
+unsigned int KmerEncoder::encodeBlockSSE2(const char *sequence, unsigned char *digitBuffer, unsigned int length)
+{
+    //Initialize function/variables
+    unsigned int numInvalid = 0;
+    unsigned int index = 0;
+
+    //Convert 16 characters at a time
+    for(; index + 16 <= length; index += 16)
+    {
+        __m128i chars = _mm_loadu_si128((const __m128i *)(sequence + index));
+        __m128i isN = _mm_cmpeq_epi8(chars, _mm_set1_epi8('N'));
+        __m128i isA = _mm_cmpeq_epi8(chars, _mm_set1_epi8('A'));
+        __m128i isT = _mm_cmpeq_epi8(chars, _mm_set1_epi8('T'));
+        __m128i isC = _mm_cmpeq_epi8(chars, _mm_set1_epi8('C'));
+        __m128i isG = _mm_cmpeq_epi8(chars, _mm_set1_epi8('G'));
+
+        //Each compare selects its own digit, unmatched lanes become INVALID_BASE
+        __m128i digits = _mm_or_si128(_mm_or_si128(_mm_and_si128(isA, _mm_set1_epi8(1)),
+                                                    _mm_and_si128(isT, _mm_set1_epi8(2))),
+                                      _mm_or_si128(_mm_and_si128(isC, _mm_set1_epi8(3)),
+                                                    _mm_and_si128(isG, _mm_set1_epi8(4))));
+        __m128i validMask = _mm_or_si128(_mm_or_si128(isN, isA), _mm_or_si128(_mm_or_si128(isT, isC), isG));
+        digits = _mm_or_si128(digits, _mm_andnot_si128(validMask, _mm_set1_epi8((char)INVALID_BASE)));
+        _mm_storeu_si128((__m128i *)(digitBuffer + index), digits);
+        numInvalid += __builtin_popcount(~_mm_movemask_epi8(validMask) & 0xFFFF);
+    }
+
+    //Convert remaining characters one at a time
+    return numInvalid + encodeBlockScalar(sequence + index, digitBuffer + index, length - index);
+}
+
+__attribute__((target("avx2")))
+unsigned int KmerEncoder::encodeBlockAVX2(const char *sequence, unsigned char *digitBuffer, unsigned int length)
+{
+    //Initialize function/variables
+    unsigned int numInvalid = 0;
+    unsigned int index = 0;
+
+    //Convert 32 characters at a time
+    for(; index + 32 <= length; index += 32)
+    {
+        __m256i chars = _mm256_loadu_si256((const __m256i *)(sequence + index));
+        __m256i isN = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('N'));
+        __m256i isA = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('A'));
+        __m256i isT = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('T'));
+        __m256i isC = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('C'));
+        __m256i isG = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('G'));
+
+        //Each compare selects its own digit, unmatched lanes become INVALID_BASE
+        __m256i digits = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(isA, _mm256_set1_epi8(1)),
+                                                          _mm256_and_si256(isT, _mm256_set1_epi8(2))),
+                                         _mm256_or_si256(_mm256_and_si256(isC, _mm256_set1_epi8(3)),
+                                                          _mm256_and_si256(isG, _mm256_set1_epi8(4))));
+        __m256i validMask = _mm256_or_si256(_mm256_or_si256(isN, isA),
+                                            _mm256_or_si256(_mm256_or_si256(isT, isC), isG));
+        digits = _mm256_or_si256(digits, _mm256_andnot_si256(validMask, _mm256_set1_epi8((char)INVALID_BASE)));
+        _mm256_storeu_si256((__m256i *)(digitBuffer + index), digits);
+        numInvalid += __builtin_popcount(~(unsigned int)_mm256_movemask_epi8(validMask));
+    }
+
+    //Convert remaining characters one at a time
+    return numInvalid + encodeBlockScalar(sequence + index, digitBuffer + index, length - index);
+}
+
+__attribute__((target("avx2")))
+unsigned long long KmerEncoder::encodeWindowAVX2(const char *sequence, bool &validFlag)
+{
+    //Initialize function/variables
+    unsigned int laneValues[4];
+
+    //Convert all 16 characters to digits, characters outside NATCG stay zero
+    __m128i chars = _mm_loadu_si128((const __m128i *)sequence);
+    __m128i isN = _mm_cmpeq_epi8(chars, _mm_set1_epi8('N'));
+    __m128i isA = _mm_cmpeq_epi8(chars, _mm_set1_epi8('A'));
+    __m128i isT = _mm_cmpeq_epi8(chars, _mm_set1_epi8('T'));
+    __m128i isC = _mm_cmpeq_epi8(chars, _mm_set1_epi8('C'));
+    __m128i isG = _mm_cmpeq_epi8(chars, _mm_set1_epi8('G'));
+    __m128i digits = _mm_or_si128(_mm_or_si128(_mm_and_si128(isA, _mm_set1_epi8(1)),
+                                                _mm_and_si128(isT, _mm_set1_epi8(2))),
+                                  _mm_or_si128(_mm_and_si128(isC, _mm_set1_epi8(3)),
+                                                _mm_and_si128(isG, _mm_set1_epi8(4))));
+    __m128i validMask = _mm_or_si128(_mm_or_si128(isN, isA), _mm_or_si128(_mm_or_si128(isT, isC), isG));
+    validFlag = (_mm_movemask_epi8(validMask) == 0xFFFF);
+
+    //Combine digit pairs (d0 + 5 d1), then pairs of pairs (p0 + 25 p1)
+    //Leaves four lanes, each holding four digits worth up to 624
+    __m128i pairValues = _mm_maddubs_epi16(digits, _mm_setr_epi8(1, 5, 1, 5, 1, 5, 1, 5,
+                                                                  1, 5, 1, 5, 1, 5, 1, 5));
+    __m128i quadValues = _mm_madd_epi16(pairValues, _mm_setr_epi16(1, 25, 1, 25, 1, 25, 1, 25));
+    _mm_storeu_si128((__m128i *)laneValues, quadValues);
+
+    //Lane k holds digits 4k to 4k+3, so it is worth 625 to the k
+    return (unsigned long long)laneValues[0]
+            + (625ull * laneValues[1])
+            + (390625ull * laneValues[2])
+            + (244140625ull * laneValues[3]);
+}
+#endif
+
+Queries_HT::Queries_HT()
+{
+    //Set all values to defaults
+    queryFilePointer = NULL;
+    numQueries = 0;
+    hashTableSize = 0;
+    maxLoadFactor = DEFAULT_LOAD_FACTOR;
+    hashArray = NULL;
+    numInvalid = 0;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+    indexMapping = NULL;
+    indexLength = 0;
+}
+
+Queries_HT::Queries_HT(FILE *queryFile, int hashSize, double loadFactor)
+{
+    //Set all values to provided data where applicable
+    queryFilePointer = queryFile;
+    numQueries = 0;
+    maxLoadFactor = loadFactor;
+    numInvalid = 0;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+    indexMapping = NULL;
+    indexLength = 0;
+
+    //Round table size up to power of two so hash index can be masked
+    hashTableSize = 1;
+    while(hashTableSize < (unsigned int)hashSize && hashTableSize < 0x80000000u)
+    {
+        hashTableSize *= 2;
+    }
+    hashArray = (HashLL *)PagePolicy::allocateBuffer((unsigned long long)hashTableSize * sizeof(HashLL));
+
+    //Initialize linked lists in all hash indices
+    for(unsigned int index = 0; index < hashTableSize; index++)
+    {
+        hashArray[index] = HashLL();
+    }
+}
+
+Queries_HT::~Queries_HT()
+{
+    //Deallocate hash array, or unmap index file holding it
+    if(indexMapping != NULL)
+    {
+        munmap(indexMapping, indexLength);
+    }
+    else
+    {
+        PagePolicy::releaseBuffer(hashArray, (unsigned long long)hashTableSize * sizeof(HashLL));
+    }
+
+    //Release all list nodes at once
+    nodeArena.clear();
+
+    //Deallocate prefilter
+    delete prefilter;
+}
+
+bool Queries_HT::searchHash(char *genomeString, unsigned int srcIndex)
+{
+    //Encode all 16 characters, windows holding characters outside NATCG never match
+    //Both strands are matched through canonical key when canonicalFlag is set
+    bool validFlag = true;
+    unsigned long long windowKey = queryEncoder.encodeWindow(genomeString, srcIndex, validFlag);
+    return validFlag && searchKey(queryEncoder.canonicalKey(windowKey));
+}
+
+bool Queries_HT::searchKey(unsigned long long windowKey)
+{
+    //First 12 characters of window give radix value for hash index
+    unsigned int indexValue = (unsigned int)(windowKey % INDEX_PLACE_VALUE);
+    unsigned int radixValue = indexValue & (hashTableSize - 1);
+
+    //Search for matching radix values of all 16 characters in table
+    return (hashArray[radixValue].search(nodeArena, indexValue, (unsigned int)(windowKey / INDEX_PLACE_VALUE)) != NULL);
+}
+
+void Queries_HT::prefetchKey(unsigned long long windowKey)
+{
+    //List head is first dependent load of search
+    __builtin_prefetch(&hashArray[(unsigned int)(windowKey % INDEX_PLACE_VALUE) & (hashTableSize - 1)]);
+}
+
+void Queries_HT::searchInterleaved(const unsigned long long *batchKeys, unsigned int numKeys, bool *batchResults)
+{
+    //Initialize function/variables
+    LookupProbe probeArray[INTERLEAVE_WIDTH];
+    unsigned int numProbes = 0;
+    unsigned int nextKey = 0;
+
+    //Start first lookups by prefetching their list heads
+    while(numProbes < INTERLEAVE_WIDTH && nextKey < numKeys)
+    {
+        LookupProbe &newProbe = probeArray[numProbes];
+        newProbe.keyIndex = nextKey;
+        newProbe.indexValue = (unsigned int)(batchKeys[nextKey] % INDEX_PLACE_VALUE);
+        newProbe.radixValue = (unsigned int)(batchKeys[nextKey] / INDEX_PLACE_VALUE);
+        newProbe.nodeIndex = newProbe.indexValue & (hashTableSize - 1);
+        newProbe.probeStage = PROBE_HEAD;
+        __builtin_prefetch(&hashArray[newProbe.nodeIndex]);
+        numProbes++;
+        nextKey++;
+    }
+
+    //Visit lookups in turn, each one does one hop then prefetches its next load
+    //By the time a lookup is visited again its load has had the others' hops to arrive
+    unsigned int probeIndex = 0;
+    while(numProbes > 0)
+    {
+        LookupProbe &wkgProbe = probeArray[probeIndex];
+        bool doneFlag = false;
+        bool matchFlag = false;
+        unsigned int nextNode;
+
+        if(wkgProbe.probeStage == PROBE_HEAD)
+        {
+            //List head has arrived, move to first node
+            nextNode = hashArray[wkgProbe.nodeIndex].headPtr;
+        }
+        else
+        {
+            //Node has arrived, check it and move to next node
+            LLNode &wkgNode = nodeArena.getNode(wkgProbe.nodeIndex);
+            matchFlag = (wkgNode.radixValue == wkgProbe.radixValue && wkgNode.indexValue == wkgProbe.indexValue);
+            nextNode = wkgNode.nextNode;
+        }
+
+        if(matchFlag || nextNode == NULL_NODE)
+        {
+            //Lookup finished, hand its slot to next key
+            batchResults[wkgProbe.keyIndex] = matchFlag;
+            doneFlag = true;
+        }
+        else
+        {
+            //Start loading next node and step aside
+            wkgProbe.nodeIndex = nextNode;
+            wkgProbe.probeStage = PROBE_NODE;
+            __builtin_prefetch(&nodeArena.getNode(nextNode));
+        }
+
+        if(doneFlag && nextKey < numKeys)
+        {
+            //Reuse slot for next key in batch
+            wkgProbe.keyIndex = nextKey;
+            wkgProbe.indexValue = (unsigned int)(batchKeys[nextKey] % INDEX_PLACE_VALUE);
+            wkgProbe.radixValue = (unsigned int)(batchKeys[nextKey] / INDEX_PLACE_VALUE);
+            wkgProbe.nodeIndex = wkgProbe.indexValue & (hashTableSize - 1);
+            wkgProbe.probeStage = PROBE_HEAD;
+            __builtin_prefetch(&hashArray[wkgProbe.nodeIndex]);
+            nextKey++;
+        }
+        else if(doneFlag)
+        {
+            //No keys left, move last lookup into finished slot
+            numProbes--;
+            probeArray[probeIndex] = probeArray[numProbes];
+            if(probeIndex == numProbes)
+            {
+                probeIndex = 0;
+            }
+            continue;
+        }
+
+        //Move to next lookup in flight
+        probeIndex++;
+        if(probeIndex == numProbes)
+        {
+            probeIndex = 0;
+        }
+    }
+}
+
+unsigned int Queries_HT::insertSequence(char *newValue)
+{
+    //Encode all 16 characters at once, skip queries outside NATCG
+    bool validFlag = true;
+    unsigned long long queryKey = queryEncoder.canonicalKey(queryEncoder.encodeWindow(newValue, 0, validFlag));
+    if(!validFlag)
+    {
+        numInvalid += 1;
+        return 0u;
+    }
+
+    //Grow hash array before load factor is exceeded
+    if(numQueries + 1 > maxLoadFactor * hashTableSize)
+    {
+        growTable();
+    }
+
+    //Add query to prefilter
+    if(prefilter != NULL)
+    {
+        prefilter->addKey(queryKey);
+    }
+
+    //First 12 characters give radix value for hash index
+    unsigned int indexValue = (unsigned int)(queryKey % INDEX_PLACE_VALUE);
+    unsigned int radixValue = indexValue & (hashTableSize - 1);
+
+    //Create temp string for insertion in new node
+    char hashHalf[13];
+    hashHalf[12] = '\0';
+    int stringIndex = 0;
+    int index;
+    for(index = 0; index < 12; index++, stringIndex++)
+    {
+        hashHalf[index] = newValue[stringIndex];
+        hashHalf[index+1] = '\0';
+    }
+
+    //Insert new node at given hash index
+    numQueries += 1;
+    return hashArray[radixValue].insert(nodeArena, LLNode(hashHalf, indexValue,
+                                                            (unsigned int)(queryKey / INDEX_PLACE_VALUE)));
+}
+
+unsigned int Queries_HT::convertToRadix(char *originalString, unsigned int index, unsigned int length)
+{
+    //Initialize intermediate variables
+    unsigned int finalValue = 0;
+    int intermediateValue;
+    int baseValue = 1;
+    unsigned int counter = 0;
+    
+    //While provided length of fragment not reached
+    do
+    {
+        //Check provided character and set base-5 value
+        switch(originalString[index])
+        {
+            case 'N':
+                intermediateValue = 0;
+                break;
+            case 'A':
+                intermediateValue = 1;
+                break;
+            case 'T':
+                intermediateValue = 2;
+                break;
+            case 'C':
+                intermediateValue = 3;
+                break;
+            case 'G':
+                intermediateValue = 4;
+                break;
+            default:
+                //Character outside NATCG has no base-5 value
+                return INVALID_QUERY;
+        }
+        //Increment final base-10 value
+        finalValue += intermediateValue * baseValue;
+        //Multiply power variable
+        baseValue *= 5;
+        //Increment counters
+        index++;
+        counter++;
+    } while (counter != length);
+
+    //Return base-10 radix value
+    return finalValue;
+    
+}
+
+unsigned int Queries_HT::findHashIndex(char *valueString, unsigned int index, unsigned int length)
+{
+    //Convert valueString to radix form
+    //Range fit resulting radix int to fit in hash table
+    return (convertToRadix(valueString, index, length) & (hashTableSize - 1));
+}
+
+unsigned int Queries_HT::fillHashes(bool timerFlag)
+{
+    //Initialize variables
+    unsigned int numCollisions = 0u;
+    struct timeval fillStartTime, fillEndTime;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Read every query character into one buffer
+    FastaReader queryReader;
+    queryReader.readQueries(queryFilePointer, QUERY_LENGTH);
+
+    //Size prefilter for every query table will hold
+    if(prefilterRate > 0.0)
+    {
+        buildPrefilter(numQueries + (unsigned int)(queryReader.sequenceLength / QUERY_LENGTH));
+    }
+
+    //Insert each full fragment of 16 characters
+    for(unsigned long long index = 0; index + QUERY_LENGTH <= queryReader.sequenceLength;
+                                                                index += QUERY_LENGTH)
+    {
+        numCollisions += insertSequence(queryReader.sequenceBuffer + index);
+    }
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the hash table");
+    }
+
+    return numCollisions;
+}
+
+unsigned int Queries_HT::fillHashes(bool timerFlag, unsigned int numThreads)
+{
+    //Initialize variables
+    struct timeval fillStartTime, fillEndTime;
+
+    //Use single thread fill when only one thread requested
+    if(numThreads <= 1)
+    {
+        return fillHashes(timerFlag);
+    }
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Read every query character into one buffer
+    FastaReader queryReader;
+    queryReader.readQueries(queryFilePointer, QUERY_LENGTH);
+    unsigned int newQueries = (unsigned int)(queryReader.sequenceLength / QUERY_LENGTH);
+
+    //Size prefilter for every query table will hold
+    if(prefilterRate > 0.0)
+    {
+        buildPrefilter(numQueries + newQueries);
+    }
+
+    //Grow hash array once up front so no thread ever resizes it
+    while(numQueries + newQueries > maxLoadFactor * hashTableSize)
+    {
+        growTable();
+    }
+
+    //Split hash indices into power of two shards, top index bits pick shard
+    unsigned int hashBits = 0;
+    while((1u << hashBits) < hashTableSize)
+    {
+        hashBits++;
+    }
+    unsigned int shardBits = 0;
+    while((1u << shardBits) < numThreads && shardBits < hashBits)
+    {
+        shardBits++;
+    }
+    unsigned int numShards = 1u << shardBits;
+    unsigned int shardShift = hashBits - shardBits;
+
+    //Encode queries in chunks, one chunk per thread
+    vector<unsigned int> indexValues(newQueries);
+    vector<unsigned int> radixValues(newQueries);
+    vector<unsigned int> shardCounts(numThreads * numShards, 0);
+    vector<unsigned int> chunkStarts(numThreads + 1);
+    vector<thread> fillThreads;
+    for(unsigned int threadIndex = 0; threadIndex <= numThreads; threadIndex++)
+    {
+        chunkStarts[threadIndex] = (unsigned int)(((unsigned long long)newQueries * threadIndex) / numThreads);
+    }
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        fillThreads.push_back(thread(&Queries_HT::encodeChunk, this, queryReader.sequenceBuffer,
+                                chunkStarts[threadIndex], chunkStarts[threadIndex + 1], shardShift,
+                                indexValues.data(), radixValues.data(), &shardCounts[threadIndex * numShards]));
+    }
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        fillThreads[threadIndex].join();
+    }
+    fillThreads.clear();
+
+    //Skip queries marked outside NATCG
+    unsigned int validQueries = 0;
+    for(unsigned int index = 0; index < numThreads * numShards; index++)
+    {
+        validQueries += shardCounts[index];
+    }
+    numInvalid += newQueries - validQueries;
+
+    //Give each shard one block of arena nodes
+    //Within a shard, each chunk writes after every earlier chunk to keep query order
+    unsigned int firstNode = nodeArena.reserveNodes(validQueries);
+    vector<unsigned int> shardStarts(numShards + 1);
+    vector<unsigned int> shardOffsets(numThreads * numShards);
+    unsigned int nodeOffset = firstNode;
+    for(unsigned int shardIndex = 0; shardIndex < numShards; shardIndex++)
+    {
+        shardStarts[shardIndex] = nodeOffset;
+        for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+        {
+            shardOffsets[threadIndex * numShards + shardIndex] = nodeOffset;
+            nodeOffset += shardCounts[threadIndex * numShards + shardIndex];
+        }
+    }
+    shardStarts[numShards] = nodeOffset;
+
+    //Copy encoded queries into their shard blocks
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        fillThreads.push_back(thread(&Queries_HT::scatterChunk, this, queryReader.sequenceBuffer,
+                                chunkStarts[threadIndex], chunkStarts[threadIndex + 1], shardShift,
+                                indexValues.data(), radixValues.data(), &shardOffsets[threadIndex * numShards]));
+    }
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        fillThreads[threadIndex].join();
+    }
+    fillThreads.clear();
+
+    //Link shards into hash array, shards never share a hash index
+    vector<unsigned int> threadCollisions(numThreads, 0);
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        fillThreads.push_back(thread(&Queries_HT::linkShards, this, threadIndex, numThreads, numShards,
+                                &shardStarts[0], &threadCollisions[threadIndex]));
+    }
+    unsigned int numCollisions = 0u;
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        fillThreads[threadIndex].join();
+        numCollisions += threadCollisions[threadIndex];
+    }
+    numQueries += validQueries;
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the hash table");
+    }
+
+    return numCollisions;
+}
+
+void Queries_HT::encodeChunk(const char *sequenceBuffer, unsigned int firstQuery, unsigned int lastQuery,
+                                unsigned int shardShift, unsigned int *indexValues, unsigned int *radixValues,
+                                unsigned int *shardCounts)
+{
+    //Encode each query and count it against its shard
+    for(unsigned int queryIndex = firstQuery; queryIndex < lastQuery; queryIndex++)
+    {
+        bool validFlag = true;
+        unsigned long long queryKey = queryEncoder.canonicalKey(queryEncoder.encodeWindow(sequenceBuffer,
+                                                (unsigned long long)queryIndex * QUERY_LENGTH, validFlag));
+        indexValues[queryIndex] = (unsigned int)(queryKey % INDEX_PLACE_VALUE);
+        radixValues[queryIndex] = (unsigned int)(queryKey / INDEX_PLACE_VALUE);
+
+        //Mark queries outside NATCG so they are not copied
+        if(!validFlag)
+        {
+            radixValues[queryIndex] = INVALID_QUERY;
+        }
+        else
+        {
+            shardCounts[(indexValues[queryIndex] & (hashTableSize - 1)) >> shardShift] += 1;
+
+            //Other chunks may set bits in same prefilter block
+            if(prefilter != NULL)
+            {
+                prefilter->addKeyShared(queryKey);
+            }
+        }
+    }
+}
+
+void Queries_HT::scatterChunk(const char *sequenceBuffer, unsigned int firstQuery, unsigned int lastQuery,
+                                unsigned int shardShift, const unsigned int *indexValues,
+                                const unsigned int *radixValues, unsigned int *shardOffsets)
+{
+    //Initialize variables
+    char hashHalf[13];
+    hashHalf[12] = '\0';
+
+    //Copy each query into next free node of its shard
+    for(unsigned int queryIndex = firstQuery; queryIndex < lastQuery; queryIndex++)
+    {
+        //Skip queries marked outside NATCG
+        if(radixValues[queryIndex] != INVALID_QUERY)
+        {
+            memcpy(hashHalf, sequenceBuffer + ((unsigned long long)queryIndex * QUERY_LENGTH), 12);
+            unsigned int shardIndex = (indexValues[queryIndex] & (hashTableSize - 1)) >> shardShift;
+            nodeArena.getNode(shardOffsets[shardIndex]) = LLNode(hashHalf, indexValues[queryIndex],
+                                                                    radixValues[queryIndex]);
+            shardOffsets[shardIndex] += 1;
+        }
+    }
+}
+
+void Queries_HT::linkShards(unsigned int firstShard, unsigned int shardStep, unsigned int numShards,
+                                const unsigned int *shardStarts, unsigned int *numCollisions)
+{
+    //Loop over every shard given to this thread
+    for(unsigned int shardIndex = firstShard; shardIndex < numShards; shardIndex += shardStep)
+    {
+        //Push nodes to list fronts from last to first, which leaves each list in the same
+        //order as appending only when table starts empty, nodes already in table end up behind new ones
+        for(unsigned int nodeIndex = shardStarts[shardIndex + 1]; nodeIndex > shardStarts[shardIndex]; nodeIndex--)
+        {
+            LLNode &wkgNode = nodeArena.getNode(nodeIndex - 1);
+            HashLL &wkgList = hashArray[wkgNode.indexValue & (hashTableSize - 1)];
+
+            //Any node joining a non-empty list is a collision
+            *numCollisions += (wkgList.headPtr != NULL_NODE);
+            wkgNode.nextNode = wkgList.headPtr;
+            wkgList.headPtr = nodeIndex - 1;
+        }
+    }
+}
+
+unsigned long long Queries_HT::memoryUsage()
+{
+    //Mapped tables use index file in place of hash array and slabs
+    if(indexMapping != NULL)
+    {
+        return indexLength + ((unsigned long long)nodeArena.slabCapacity * sizeof(LLNode*))
+                + ((prefilter != NULL) ? prefilter->memoryUsage() : 0);
+    }
+
+    //Count hash array plus every slab held by node arena
+    return ((unsigned long long)hashTableSize * sizeof(HashLL))
+            + ((unsigned long long)nodeArena.numSlabs * SLAB_NODES * sizeof(LLNode))
+            + ((unsigned long long)nodeArena.slabCapacity * sizeof(LLNode*))
+            + ((prefilter != NULL) ? prefilter->memoryUsage() : 0);
+}
+
+void Queries_HT::buildPrefilter(unsigned int numKeys)
+{
+    //Replace any earlier prefilter
+    delete prefilter;
+    prefilter = new BloomFilter(numKeys, prefilterRate);
+
+    //Add every query already stored in node arena
+    for(unsigned int nodeIndex = 0; nodeIndex < nodeArena.numNodes; nodeIndex++)
+    {
+        LLNode &wkgNode = nodeArena.getNode(nodeIndex);
+        prefilter->addKey(wkgNode.indexValue + (wkgNode.radixValue * INDEX_PLACE_VALUE));
+    }
+}
+
+void Queries_HT::collectStats(TableStats &tableStats)
+{
+    //Walk every list once
+    tableStats.numBuckets = hashTableSize;
+    tableStats.numQueries = numQueries;
+    tableStats.tableBytes = memoryUsage();
+    tableStats.usedBuckets = 0;
+    tableStats.longestChain = 0;
+    tableStats.chainHistogram.assign(CHAIN_HISTOGRAM_BINS + 1, 0);
+    for(unsigned int index = 0; index < hashTableSize; index++)
+    {
+        unsigned long long chainLength = 0;
+        for(unsigned int wkgIndex = hashArray[index].headPtr; wkgIndex != NULL_NODE;
+                                                    wkgIndex = nodeArena.getNode(wkgIndex).nextNode)
+        {
+            chainLength++;
+        }
+        tableStats.usedBuckets += (chainLength > 0);
+        tableStats.longestChain = max(tableStats.longestChain, chainLength);
+        tableStats.chainHistogram[min(chainLength, (unsigned long long)CHAIN_HISTOGRAM_BINS)]++;
+    }
+}
+
+void Queries_HT::probeGenome(const char *genomeString, unsigned long long numSubstrings, TableStats &tableStats)
+{
+    //Initialize function/variables
+    KmerEncoder windowEncoder;
+    windowEncoder.canonicalFlag = queryEncoder.canonicalFlag;
+    tableStats.numLookups = 0;
+    tableStats.numProbes = 0;
+    tableStats.numHits = 0;
+
+    for(unsigned long long charIndex = 0; charIndex < numSubstrings + QUERY_LENGTH - 1; charIndex++)
+    {
+        //Look up same windows as scan, prefilter rejects never reach table
+        unsigned long long lookupKey;
+        if(windowEncoder.canonicalFlag)
+        {
+            lookupKey = windowEncoder.rollCanonical(windowEncoder.encodeBase(genomeString[charIndex]));
+        }
+        else
+        {
+            lookupKey = windowEncoder.rollDigit(windowEncoder.encodeBase(genomeString[charIndex]));
+        }
+        if(!windowEncoder.windowValid() || (prefilter != NULL && !prefilter->mayContain(lookupKey)))
+        {
+            continue;
+        }
+
+        //Walk list as searchKey does, counting every node visited
+        unsigned int indexValue = (unsigned int)(lookupKey % INDEX_PLACE_VALUE);
+        unsigned int radixValue = (unsigned int)(lookupKey / INDEX_PLACE_VALUE);
+        tableStats.numLookups++;
+        for(unsigned int wkgIndex = hashArray[indexValue & (hashTableSize - 1)].headPtr; wkgIndex != NULL_NODE; )
+        {
+            LLNode &wkgNode = nodeArena.getNode(wkgIndex);
+            tableStats.numProbes++;
+            if(wkgNode.radixValue == radixValue && wkgNode.indexValue == indexValue)
+            {
+                tableStats.numHits++;
+                break;
+            }
+            wkgIndex = wkgNode.nextNode;
+        }
+    }
+}
+
+TableStats::TableStats()
+{
+    //Set all counts to zero
+    numBuckets = 0;
+    usedBuckets = 0;
+    numQueries = 0;
+    tableBytes = 0;
+    longestChain = 0;
+    numLookups = 0;
+    numProbes = 0;
+    numHits = 0;
+}
+
+void TableStats::printStats(std::ostream &outputStream)
+{
+    outputStream << "Buckets used: " << usedBuckets << " of " << numBuckets << " ("
+                    << fixed << setprecision(1) << (100.0 * usedBuckets / (numBuckets > 0 ? numBuckets : 1))
+                    << "%), load factor " << setprecision(3) << ((double)numQueries / (numBuckets > 0 ? numBuckets : 1))
+                    << endl;
+    outputStream << "Longest chain: " << longestChain << " nodes" << endl;
+    outputStream << "Bytes per query: " << setprecision(1) << ((double)tableBytes / (numQueries > 0 ? numQueries : 1))
+                    << endl;
+    outputStream << "Chain length histogram:" << endl;
+    for(unsigned int index = 0; index < chainHistogram.size(); index++)
+    {
+        if(chainHistogram[index] > 0)
+        {
+            outputStream << "  " << setw(3) << index << ((index == CHAIN_HISTOGRAM_BINS) ? "+ " : "  ")
+                            << chainHistogram[index] << endl;
+        }
+    }
+    if(numLookups > 0)
+    {
+        outputStream << "Lookups: " << numLookups << ", hits " << numHits << ", misses " << (numLookups - numHits)
+                        << ", " << setprecision(3) << ((double)numProbes / numLookups) << " nodes visited per lookup"
+                        << endl;
+    }
+    outputStream.unsetf(ios::floatfield);
+    outputStream << setprecision(6);
+}
+
+bool TableStats::writeJSON(const char *jsonPath)
+{
+    FILE *jsonFile = fopen(jsonPath, "w");
+    if(jsonFile == NULL)
+    {
+        return false;
+    }
+
+    //Field names match printed stats, histogram index is chain length
+    fprintf(jsonFile, "{\n  \"buckets\": %llu,\n  \"used_buckets\": %llu,\n  \"queries\": %llu,\n",
+                numBuckets, usedBuckets, numQueries);
+    fprintf(jsonFile, "  \"load_factor\": %.6f,\n  \"table_bytes\": %llu,\n  \"bytes_per_query\": %.3f,\n",
+                (double)numQueries / (numBuckets > 0 ? numBuckets : 1), tableBytes,
+                (double)tableBytes / (numQueries > 0 ? numQueries : 1));
+    fprintf(jsonFile, "  \"longest_chain\": %llu,\n  \"chain_histogram\": [", longestChain);
+    for(unsigned int index = 0; index < chainHistogram.size(); index++)
+    {
+        fprintf(jsonFile, "%s%llu", (index > 0) ? ", " : "", chainHistogram[index]);
+    }
+    fprintf(jsonFile, "],\n  \"lookups\": %llu,\n  \"probes\": %llu,\n  \"hits\": %llu,\n  \"misses\": %llu,\n",
+                numLookups, numProbes, numHits, numLookups - numHits);
+    fprintf(jsonFile, "  \"probes_per_lookup\": %.6f\n}\n", (double)numProbes / (numLookups > 0 ? numLookups : 1));
+    return (fclose(jsonFile) == 0);
+}
+
+void Queries_HT::growTable()
+{
+    //Keep old array until all nodes are relinked
+    HashLL *oldArray = hashArray;
+    unsigned int oldSize = hashTableSize;
+
+    //Double size of hash array
+    if(hashTableSize == 0)
+    {
+        hashTableSize = 1;
+    }
+    hashTableSize *= 2;
+    hashArray = (HashLL *)PagePolicy::allocateBuffer((unsigned long long)hashTableSize * sizeof(HashLL));
+    for(unsigned int index = 0; index < hashTableSize; index++)
+    {
+        hashArray[index] = HashLL();
+    }
+
+    //Move every node to front of its list in new array
+    for(unsigned int index = 0; index < oldSize; index++)
+    {
+        unsigned int wkgIndex = oldArray[index].headPtr;
+        while(wkgIndex != NULL_NODE)
+        {
+            LLNode &wkgNode = nodeArena.getNode(wkgIndex);
+            unsigned int nextIndex = wkgNode.nextNode;
+            HashLL &newList = hashArray[wkgNode.indexValue & (hashTableSize - 1)];
+            wkgNode.nextNode = newList.headPtr;
+            newList.headPtr = wkgIndex;
+            wkgIndex = nextIndex;
+        }
+    }
+
+    //Deallocate old hash array
+    PagePolicy::releaseBuffer(oldArray, (unsigned long long)oldSize * sizeof(HashLL));
+}
+
+bool Queries_HT::writeIndex(const char *indexPath)
+{
+    //Initialize header and padding
+    static_assert(sizeof(IndexHeader) <= INDEX_HEADER_BYTES, "index header outgrew its slot");
+    IndexHeader fileHeader;
+    char zeroPadding[INDEX_ALIGN] = {0};
+    memset(&fileHeader, 0, sizeof(IndexHeader));
+    fileHeader.magicNumber = INDEX_MAGIC;
+    fileHeader.formatVersion = INDEX_VERSION;
+    fileHeader.nodeBytes = sizeof(LLNode);
+    fileHeader.headBytes = sizeof(HashLL);
+    fileHeader.hashTableSize = hashTableSize;
+    fileHeader.numQueries = numQueries;
+    fileHeader.numNodes = nodeArena.numNodes;
+    fileHeader.numInvalid = numInvalid;
+    fileHeader.canonicalKeys = queryEncoder.canonicalFlag;
+
+    //Heads start after header, nodes start on next aligned offset after heads
+    unsigned long long headLength = (unsigned long long)hashTableSize * sizeof(HashLL);
+    fileHeader.headOffset = INDEX_HEADER_BYTES;
+    fileHeader.nodeOffset = (fileHeader.headOffset + headLength + INDEX_ALIGN - 1) & ~(unsigned long long)(INDEX_ALIGN - 1);
+
+    //Checksum heads, then nodes slab by slab in arena order
+    fileHeader.payloadChecksum = checksumBytes(hashArray, headLength, INDEX_MAGIC);
+    for(unsigned int slabIndex = 0; slabIndex < nodeArena.numSlabs; slabIndex++)
+    {
+        unsigned int slabCount = nodeArena.numNodes - (slabIndex * SLAB_NODES);
+        if(slabCount > SLAB_NODES)
+        {
+            slabCount = SLAB_NODES;
+        }
+        fileHeader.payloadChecksum = checksumBytes(nodeArena.slabArray[slabIndex],
+                                        (unsigned long long)slabCount * sizeof(LLNode), fileHeader.payloadChecksum);
+    }
+
+    //Check file opened
+    FILE *indexFile = fopen(indexPath, "wb");
+    if(indexFile == NULL)
+    {
+        return false;
+    }
+
+    //Write header, heads, padding and nodes
+    bool writeFlag = (fwrite(&fileHeader, sizeof(IndexHeader), 1, indexFile) == 1);
+    unsigned long long padLength = INDEX_HEADER_BYTES - sizeof(IndexHeader);
+    writeFlag = writeFlag && (fwrite(zeroPadding, 1, padLength, indexFile) == padLength);
+    writeFlag = writeFlag && (fwrite(hashArray, sizeof(HashLL), hashTableSize, indexFile) == hashTableSize);
+    padLength = fileHeader.nodeOffset - fileHeader.headOffset - headLength;
+    writeFlag = writeFlag && (fwrite(zeroPadding, 1, padLength, indexFile) == padLength);
+    for(unsigned int slabIndex = 0; slabIndex < nodeArena.numSlabs && writeFlag; slabIndex++)
+    {
+        unsigned int slabCount = nodeArena.numNodes - (slabIndex * SLAB_NODES);
+        if(slabCount > SLAB_NODES)
+        {
+            slabCount = SLAB_NODES;
+        }
+        writeFlag = (fwrite(nodeArena.slabArray[slabIndex], sizeof(LLNode), slabCount, indexFile) == slabCount);
+    }
+
+    //Report any failed write, including failed flush on close
+    writeFlag = (fclose(indexFile) == 0) && writeFlag;
+    return writeFlag;
+}
+
+bool Queries_HT::loadIndex(const char *indexPath, bool verifyFlag)
+{
+    //Check file opened
+    FILE *indexFile = fopen(indexPath, "rb");
+    if(indexFile == NULL)
+    {
+        return false;
+    }
+
+    //Map whole file shared so concurrent jobs share page cache
+    struct stat fileStats;
+    void *fileData = MAP_FAILED;
+    if(fstat(fileno(indexFile), &fileStats) == 0 && fileStats.st_size >= INDEX_HEADER_BYTES)
+    {
+        fileData = mmap(NULL, fileStats.st_size, PROT_READ, MAP_SHARED, fileno(indexFile), 0);
+    }
+    fclose(indexFile);
+    if(fileData == MAP_FAILED)
+    {
+        return false;
+    }
+    unsigned long long fileLength = fileStats.st_size;
+    const IndexHeader *fileHeader = (const IndexHeader *)fileData;
+    const char *fileBytes = (const char *)fileData;
+
+    //Check header matches this build and file holds every section
+    unsigned long long headLength = (unsigned long long)fileHeader->hashTableSize * sizeof(HashLL);
+    unsigned long long nodeLength = (unsigned long long)fileHeader->numNodes * sizeof(LLNode);
+    bool validFlag = (fileHeader->magicNumber == INDEX_MAGIC)
+                        && (fileHeader->formatVersion == INDEX_VERSION)
+                        && (fileHeader->nodeBytes == sizeof(LLNode))
+                        && (fileHeader->headBytes == sizeof(HashLL))
+                        && (fileHeader->hashTableSize != 0)
+                        && ((fileHeader->hashTableSize & (fileHeader->hashTableSize - 1)) == 0)
+                        && (fileHeader->headOffset >= INDEX_HEADER_BYTES)
+                        && (fileHeader->headOffset + headLength <= fileHeader->nodeOffset)
+                        && (fileHeader->nodeOffset % INDEX_ALIGN == 0)
+                        && (fileHeader->nodeOffset + nodeLength == fileLength);
+
+    //Check payload has not changed since it was written
+    if(validFlag && verifyFlag)
+    {
+        unsigned long long payloadChecksum = checksumBytes(fileBytes + fileHeader->headOffset, headLength, INDEX_MAGIC);
+        payloadChecksum = checksumBytes(fileBytes + fileHeader->nodeOffset, nodeLength, payloadChecksum);
+        validFlag = (payloadChecksum == fileHeader->payloadChecksum);
+    }
+    if(!validFlag)
+    {
+        munmap(fileData, fileLength);
+        return false;
+    }
+
+    //Release anything held before
+    if(indexMapping != NULL)
+    {
+        munmap(indexMapping, indexLength);
+    }
+    else
+    {
+        PagePolicy::releaseBuffer(hashArray, (unsigned long long)hashTableSize * sizeof(HashLL));
+    }
+
+    //Use mapped sections directly as hash array and node slabs
+    indexMapping = fileData;
+    indexLength = fileLength;
+    hashTableSize = fileHeader->hashTableSize;
+    numQueries = fileHeader->numQueries;
+    numInvalid = fileHeader->numInvalid;
+    queryEncoder.canonicalFlag = (fileHeader->canonicalKeys != 0);
+    hashArray = (HashLL *)(fileBytes + fileHeader->headOffset);
+    nodeArena.attachNodes((LLNode *)(fileBytes + fileHeader->nodeOffset), fileHeader->numNodes);
+
+    //Rebuild prefilter from mapped nodes when requested
+    if(prefilterRate > 0.0)
+    {
+        buildPrefilter(nodeArena.numNodes);
+    }
+    return true;
+}
+
+Queries_FlatHT::Queries_FlatHT()
+{
+    //Set all values to defaults
+    queryFilePointer = NULL;
+    numQueries = 0;
+    hashTableSize = 0;
+    hashBits = 0;
+    maxLoadFactor = DEFAULT_LOAD_FACTOR;
+    slotArray = NULL;
+    numInvalid = 0;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+}
+
+Queries_FlatHT::Queries_FlatHT(FILE *queryFile, int hashSize, double loadFactor)
+{
+    //Set all values to provided data where applicable
+    queryFilePointer = queryFile;
+    numQueries = 0;
+    maxLoadFactor = loadFactor;
+    numInvalid = 0;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+
+    //Round table size up to power of two so slot index can be masked
+    hashBits = 1;
+    hashTableSize = 2;
+    while(hashTableSize < (unsigned int)hashSize && hashBits < 31)
+    {
+        hashTableSize *= 2;
+        hashBits++;
+    }
+    slotArray = (unsigned long long *)PagePolicy::allocateBuffer((unsigned long long)hashTableSize
+                                                                    * sizeof(unsigned long long));
+
+    //Mark all slots as empty
+    for(unsigned int index = 0; index < hashTableSize; index++)
+    {
+        slotArray[index] = EMPTY_SLOT;
+    }
+}
+
+Queries_FlatHT::~Queries_FlatHT()
+{
+    //Deallocate slot array and prefilter
+    PagePolicy::releaseBuffer(slotArray, (unsigned long long)hashTableSize * sizeof(unsigned long long));
+    delete prefilter;
+}
+
+bool Queries_FlatHT::searchHash(char *genomeString, unsigned int srcIndex)
+{
+    //Encode all 16 characters and search using full key
+    bool validFlag = true;
+    unsigned long long windowKey = queryEncoder.encodeWindow(genomeString, srcIndex, validFlag);
+    return validFlag && searchKey(queryEncoder.canonicalKey(windowKey));
+}
+
+bool Queries_FlatHT::searchKey(unsigned long long windowKey)
+{
+    //Start at home slot for key
+    unsigned int slotIndex = findSlotIndex(windowKey);
+
+    //Probe consecutive slots until match or empty slot found
+    while(slotArray[slotIndex] != EMPTY_SLOT)
+    {
+        //Check for matching key
+        if(slotArray[slotIndex] == windowKey)
+        {
+            return true;
+        }
+        //Move to next slot, wrapping at end of array
+        slotIndex = (slotIndex + 1) & (hashTableSize - 1);
+    }
+    //Empty slot reached, no match found
+    return false;
+}
+
+void Queries_FlatHT::prefetchKey(unsigned long long windowKey)
+{
+    //Home slot is first load of probe sequence
+    __builtin_prefetch(&slotArray[findSlotIndex(windowKey)]);
+}
+
+unsigned int Queries_FlatHT::insertSequence(char *newValue)
+{
+    //Encode all 16 characters, skip queries outside NATCG
+    bool validFlag = true;
+    unsigned long long queryKey = queryEncoder.canonicalKey(queryEncoder.encodeWindow(newValue, 0, validFlag));
+    if(!validFlag)
+    {
+        numInvalid += 1;
+        return 0u;
+    }
+
+    //Insert using full key
+    return insertKey(queryKey);
+}
+
+unsigned int Queries_FlatHT::insertKey(unsigned long long newKey)
+{
+    //Grow slot array before load factor is exceeded
+    //Always keep one slot empty so searches terminate
+    if(numQueries + 1 > maxLoadFactor * hashTableSize || numQueries + 1 >= hashTableSize)
+    {
+        growTable();
+    }
+
+    //Start at home slot for key
+    unsigned int slotIndex = findSlotIndex(newKey);
+    unsigned int collisionFlag = 0u;
+
+    //Probe consecutive slots until match or empty slot found
+    while(slotArray[slotIndex] != EMPTY_SLOT)
+    {
+        //Check for duplicate query, already stored
+        if(slotArray[slotIndex] == newKey)
+        {
+            return collisionFlag;
+        }
+        //Move to next slot, wrapping at end of array
+        slotIndex = (slotIndex + 1) & (hashTableSize - 1);
+        collisionFlag = 1u;
+    }
+
+    //Store key in empty slot and add it to prefilter
+    slotArray[slotIndex] = newKey;
+    if(prefilter != NULL)
+    {
+        prefilter->addKey(newKey);
+    }
+    numQueries += 1;
+    return collisionFlag;
+}
+
+unsigned int Queries_FlatHT::fillHashes(bool timerFlag)
+{
+    //Initialize variables
+    unsigned int numCollisions = 0u;
+    struct timeval fillStartTime, fillEndTime;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Read every query character into one buffer
+    FastaReader queryReader;
+    queryReader.readQueries(queryFilePointer, QUERY_LENGTH);
+
+    //Size prefilter for every query table will hold
+    if(prefilterRate > 0.0)
+    {
+        buildPrefilter(numQueries + (unsigned int)(queryReader.sequenceLength / QUERY_LENGTH));
+    }
+
+    //Insert each full fragment of 16 characters
+    for(unsigned long long index = 0; index + QUERY_LENGTH <= queryReader.sequenceLength;
+                                                                index += QUERY_LENGTH)
+    {
+        numCollisions += insertSequence(queryReader.sequenceBuffer + index);
+    }
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the hash table");
+    }
+
+    return numCollisions;
+}
+
+unsigned long long Queries_FlatHT::memoryUsage()
+{
+    //Count slot array, keys are stored inline
+    return ((unsigned long long)hashTableSize * sizeof(unsigned long long))
+            + ((prefilter != NULL) ? prefilter->memoryUsage() : 0);
+}
+
+void Queries_FlatHT::buildPrefilter(unsigned int numKeys)
+{
+    //Replace any earlier prefilter
+    delete prefilter;
+    prefilter = new BloomFilter(numKeys, prefilterRate);
+
+    //Add every query already stored in slot array
+    for(unsigned int index = 0; index < hashTableSize; index++)
+    {
+        if(slotArray[index] != EMPTY_SLOT)
+        {
+            prefilter->addKey(slotArray[index]);
+        }
+    }
+}
+
+void Queries_FlatHT::growTable()
+{
+    //Keep old array until all keys are reinserted
+    unsigned long long *oldArray = slotArray;
+    unsigned int oldSize = hashTableSize;
+
+    //Double size of slot array and mark all slots as empty
+    if(hashTableSize == 0)
+    {
+        hashTableSize = 1;
+        hashBits = 0;
+    }
+    hashTableSize *= 2;
+    hashBits++;
+    slotArray = (unsigned long long *)PagePolicy::allocateBuffer((unsigned long long)hashTableSize
+                                                                    * sizeof(unsigned long long));
+    for(unsigned int index = 0; index < hashTableSize; index++)
+    {
+        slotArray[index] = EMPTY_SLOT;
+    }
+
+    //Reinsert every stored key, no duplicates are possible
+    for(unsigned int index = 0; index < oldSize; index++)
+    {
+        if(oldArray[index] != EMPTY_SLOT)
+        {
+            unsigned int slotIndex = findSlotIndex(oldArray[index]);
+            while(slotArray[slotIndex] != EMPTY_SLOT)
+            {
+                slotIndex = (slotIndex + 1) & (hashTableSize - 1);
+            }
+            slotArray[slotIndex] = oldArray[index];
+        }
+    }
+
+    //Deallocate old slot array
+    PagePolicy::releaseBuffer(oldArray, (unsigned long long)oldSize * sizeof(unsigned long long));
+}
+
+unsigned int Queries_FlatHT::findSlotIndex(unsigned long long key)
+{
+    //Multiplicative hash, keep top bits of product as home slot
+    return (unsigned int)((key * 0x9E3779B97F4A7C15ull) >> (64 - hashBits));
+}
+
+int compareString(const char *oneStr, const char *otherStr)
+{
+    //Initialize function/variables
+    int diff, index = 0;
+
+    //Loop to end of shortest string
+    while(oneStr[index] != '\0'
+         && otherStr[index] != '\0')
+    {
+        //Get difference in characters
+        diff = oneStr[index] - otherStr[index];
+        //Check for difference between characters
+        if(diff != 0)
+        {
+            //Difference found, return difference
+            return diff;
+        }
+        //Increment index
+        index++;
+    }
+    //End Loop
+
+    //Return difference in lengths if exists
+        //Function: getStringLength
+    return getStringLength(oneStr) - getStringLength(otherStr);
+}
+
+unsigned int getStringLength(const char *testStr)
+{
+    //Initialize function/variables
+    unsigned int index = 0;
+
+    //Loop to end of string
+    while(testStr[index] != '\0')
+    {
+        //Update index
+        index++;
+    }
+    //End Loop
+
+    //Return index (Max string index is [index-1])
+    return index;
+}
+
+void copyString(char *destStr, const char *sourceStr)
+{
+    //Initialize function/variables
+    int index = 0;
+
+    //Check that source string is not identical to dest string
+    if(compareString(destStr, sourceStr) != 0)
+    {
+        //Loop to end of source string
+        while(sourceStr[index] != '\0' && index < '\0')
+        {
+            //Assign characters to end of dest string
+            destStr[index] = sourceStr[index];
+
+            //Update Index
+            index++;
+
+            //set temp end of dest string
+            destStr[index] = '\0';
+        }
+        //End Loop
+    }
+}
+
+BloomFilter::BloomFilter(unsigned int numKeys, double falsePositiveRate)
+{
+    //Find bits per key and bits per key set for requested rate
+    //(Blocked filter runs slightly above this rate at same size)
+    double bitsPerKey = -log(falsePositiveRate) / (log(2.0) * log(2.0));
+    numHashes = (unsigned int)(bitsPerKey * log(2.0) + 0.5);
+    if(numHashes < 1)
+    {
+        numHashes = 1;
+    }
+    if(numHashes > BLOOM_MAX_HASHES)
+    {
+        numHashes = BLOOM_MAX_HASHES;
+    }
+
+    //Round number of blocks up to power of two
+    double totalBits = bitsPerKey * (numKeys + 1);
+    numBlocks = 1;
+    blockBits = 0;
+    while(numBlocks * 64.0 * BLOOM_BLOCK_WORDS < totalBits && blockBits < 26)
+    {
+        numBlocks *= 2;
+        blockBits++;
+    }
+
+    //Align blocks to cache lines so each lookup touches one line
+    void *blockMemory = NULL;
+    if(posix_memalign(&blockMemory, 64, (size_t)numBlocks * BLOOM_BLOCK_WORDS * sizeof(unsigned long long)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    blockArray = (unsigned long long *)blockMemory;
+    memset(blockArray, 0, (size_t)numBlocks * BLOOM_BLOCK_WORDS * sizeof(unsigned long long));
+}
+
+BloomFilter::~BloomFilter()
+{
+    //Deallocate block array
+    free(blockArray);
+}
+
+void BloomFilter::addKey(unsigned long long key)
+{
+    //Mix key, top bits pick block, rest step through bits of block
+    unsigned long long hashValue = (key ^ (key >> 29)) * 0x9E3779B97F4A7C15ull;
+    unsigned long long *wkgBlock = blockArray
+                    + ((blockBits == 0) ? 0 : (hashValue >> (64 - blockBits))) * BLOOM_BLOCK_WORDS;
+    unsigned int bitIndex = (unsigned int)hashValue;
+    unsigned int bitStep = (unsigned int)(hashValue >> 23) | 1u;
+
+    //Set every bit of key within block
+    for(unsigned int hashIndex = 0; hashIndex < numHashes; hashIndex++, bitIndex += bitStep)
+    {
+        wkgBlock[(bitIndex >> 6) & (BLOOM_BLOCK_WORDS - 1)] |= (1ull << (bitIndex & 63));
+    }
+}
+
+void BloomFilter::addKeyShared(unsigned long long key)
+{
+    //Same bits as addKey, set with atomic or so no update is lost
+    unsigned long long hashValue = (key ^ (key >> 29)) * 0x9E3779B97F4A7C15ull;
+    unsigned long long *wkgBlock = blockArray
+                    + ((blockBits == 0) ? 0 : (hashValue >> (64 - blockBits))) * BLOOM_BLOCK_WORDS;
+    unsigned int bitIndex = (unsigned int)hashValue;
+    unsigned int bitStep = (unsigned int)(hashValue >> 23) | 1u;
+
+    for(unsigned int hashIndex = 0; hashIndex < numHashes; hashIndex++, bitIndex += bitStep)
+    {
+        __atomic_fetch_or(&wkgBlock[(bitIndex >> 6) & (BLOOM_BLOCK_WORDS - 1)],
+                            (1ull << (bitIndex & 63)), __ATOMIC_RELAXED);
+    }
+}
+
+bool BloomFilter::mayContain(unsigned long long key)
+{
+    //Find same block and bits as addKey
+    unsigned long long hashValue = (key ^ (key >> 29)) * 0x9E3779B97F4A7C15ull;
+    const unsigned long long *wkgBlock = blockArray
+                    + ((blockBits == 0) ? 0 : (hashValue >> (64 - blockBits))) * BLOOM_BLOCK_WORDS;
+    unsigned int bitIndex = (unsigned int)hashValue;
+    unsigned int bitStep = (unsigned int)(hashValue >> 23) | 1u;
+    unsigned long long allSet = 1;
+
+    //Check every bit without branching, all must be set
+    for(unsigned int hashIndex = 0; hashIndex < numHashes; hashIndex++, bitIndex += bitStep)
+    {
+        allSet &= (wkgBlock[(bitIndex >> 6) & (BLOOM_BLOCK_WORDS - 1)] >> (bitIndex & 63));
+    }
+    return (allSet & 1) != 0;
+}
+
+unsigned long long BloomFilter::memoryUsage()
+{
+    //Count block array
+    return (unsigned long long)numBlocks * BLOOM_BLOCK_WORDS * sizeof(unsigned long long);
+}
+
+unsigned int PagePolicy::pageMode = PAGES_NORMAL;
+bool PagePolicy::interleaveFlag = false;
+unsigned long long PagePolicy::hugeBytes = 0;
+unsigned long long PagePolicy::transparentBytes = 0;
+unsigned long long PagePolicy::normalBytes = 0;
+
+unsigned long long PagePolicy::mappedLength(unsigned long long numBytes)
+{
+    unsigned long long pageBytes = (numBytes >= HUGE_PAGE_BYTES) ? HUGE_PAGE_BYTES : SMALL_PAGE_BYTES;
+    if(numBytes == 0)
+    {
+        numBytes = 1;
+    }
+    return (numBytes + pageBytes - 1) & ~(pageBytes - 1);
+}
+
+void *PagePolicy::allocateBuffer(unsigned long long numBytes)
+{
+    //Initialize function/variables
+    unsigned long long mapLength = mappedLength(numBytes);
+    bool hugeFlag = (pageMode == PAGES_HUGE && mapLength >= HUGE_PAGE_BYTES);
+    void *bufferData = MAP_FAILED;
+
+    //Explicit huge pages only exist when administrator reserved them
+    if(hugeFlag)
+    {
+        bufferData = mmap(NULL, mapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(bufferData != MAP_FAILED)
+        {
+            hugeBytes += mapLength;
+            interleavePages(bufferData, mapLength);
+            return bufferData;
+        }
+    }
+
+    //Transparent huge pages need 2 MB aligned range, so map extra and trim both ends
+    unsigned long long extraLength = hugeFlag ? HUGE_PAGE_BYTES : 0;
+    char *wideData = (char *)mmap(NULL, mapLength + extraLength, PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(wideData == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    char *alignedData = wideData;
+    if(hugeFlag)
+    {
+        alignedData = (char *)(((unsigned long long)wideData + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1));
+        if(alignedData > wideData)
+        {
+            munmap(wideData, alignedData - wideData);
+        }
+        if(wideData + mapLength + extraLength > alignedData + mapLength)
+        {
+            munmap(alignedData + mapLength, (wideData + mapLength + extraLength) - (alignedData + mapLength));
+        }
+    }
+
+    //Place pages before anything touches them
+    interleavePages(alignedData, mapLength);
+    if(hugeFlag && madvise(alignedData, mapLength, MADV_HUGEPAGE) == 0)
+    {
+        transparentBytes += mapLength;
+    }
+    else
+    {
+        normalBytes += mapLength;
+    }
+    return alignedData;
+}
+
+void PagePolicy::releaseBuffer(void *bufferData, unsigned long long numBytes)
+{
+    if(bufferData != NULL)
+    {
+        munmap(bufferData, mappedLength(numBytes));
+    }
+}
+
+void PagePolicy::interleavePages(void *bufferData, unsigned long long mapLength)
+{
+    if(!interleaveFlag)
+    {
+        return;
+    }
+
+    //Read online nodes as ranges like "0-3,8-11"
+    unsigned long long nodeMask[MAX_NUMA_NODES / 64];
+    memset(nodeMask, 0, sizeof(nodeMask));
+    unsigned int numNodes = 0;
+    FILE *nodeFile = fopen("/sys/devices/system/node/online", "r");
+    if(nodeFile == NULL)
+    {
+        return;
+    }
+    unsigned int firstNode, lastNode;
+    while(fscanf(nodeFile, "%u", &firstNode) == 1)
+    {
+        lastNode = firstNode;
+        int nextChar = fgetc(nodeFile);
+        if(nextChar == '-' && fscanf(nodeFile, "%u", &lastNode) == 1)
+        {
+            nextChar = fgetc(nodeFile);
+        }
+        for(unsigned int node = firstNode; node <= lastNode && node < MAX_NUMA_NODES; node++)
+        {
+            nodeMask[node / 64] |= 1ull << (node % 64);
+            numNodes++;
+        }
+        if(nextChar != ',')
+        {
+            break;
+        }
+    }
+    fclose(nodeFile);
+
+    //Interleaving over one node changes nothing, failure leaves kernel default placement
+    if(numNodes > 1)
+    {
+        syscall(SYS_mbind, bufferData, mapLength, MPOL_INTERLEAVE_MODE, nodeMask, (unsigned long)MAX_NUMA_NODES, 0);
+    }
+}
+
+bool PerfCounters::countingFlag = false;
+bool ScanResult::keepAllFlag = true;
+
+PerfCounters::PerfCounters()
+{
+    //Set every count to zero
+    for(unsigned int index = 0; index < NUM_COUNTERS; index++)
+    {
+        counterFds[index] = -1;
+        counterValues[index] = 0;
+    }
+    openedMask = 0;
+    wallUSec = 0;
+    startTime.tv_sec = 0;
+    startTime.tv_usec = 0;
+}
+
+void PerfCounters::startCounters(bool inheritFlag)
+{
+    //Event type and config of each counter
+    const unsigned int eventTypes[NUM_COUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                    PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    const unsigned long long eventConfigs[NUM_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES};
+
+    //Open each counter on its own, a missing event leaves others working
+    for(unsigned int index = 0; index < NUM_COUNTERS; index++)
+    {
+        struct perf_event_attr eventAttr;
+        memset(&eventAttr, 0, sizeof(eventAttr));
+        eventAttr.size = sizeof(eventAttr);
+        eventAttr.type = eventTypes[index];
+        eventAttr.config = eventConfigs[index];
+        eventAttr.disabled = 1;
+        eventAttr.exclude_kernel = 1;
+        eventAttr.exclude_hv = 1;
+        eventAttr.inherit = inheritFlag;
+        eventAttr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counterFds[index] = (int)syscall(SYS_perf_event_open, &eventAttr, 0, -1, -1, 0);
+        if(counterFds[index] >= 0)
+        {
+            openedMask |= 1u << index;
+        }
+    }
+
+    //Start counters and clock as close together as possible
+    for(unsigned int index = 0; index < NUM_COUNTERS; index++)
+    {
+        if(counterFds[index] >= 0)
+        {
+            ioctl(counterFds[index], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    gettimeofday( &startTime, NULL);
+}
+
+void PerfCounters::stopCounters()
+{
+    struct timeval endTime;
+    gettimeofday( &endTime, NULL);
+    wallUSec += elapsedUSecs(startTime, endTime);
+
+    for(unsigned int index = 0; index < NUM_COUNTERS; index++)
+    {
+        if(counterFds[index] < 0)
+        {
+            continue;
+        }
+        ioctl(counterFds[index], PERF_EVENT_IOC_DISABLE, 0);
+
+        //Value, time enabled and time running, scale up if counter was only running part of time
+        unsigned long long readValues[3];
+        if(read(counterFds[index], readValues, sizeof(readValues)) == (ssize_t)sizeof(readValues) && readValues[2] > 0)
+        {
+            counterValues[index] += (unsigned long long)((double)readValues[0] * readValues[1] / readValues[2]);
+        }
+        close(counterFds[index]);
+        counterFds[index] = -1;
+    }
+}
+
+void PerfCounters::addCounters(const PerfCounters &otherCounters)
+{
+    for(unsigned int index = 0; index < NUM_COUNTERS; index++)
+    {
+        counterValues[index] += otherCounters.counterValues[index];
+    }
+    openedMask |= otherCounters.openedMask;
+    wallUSec += otherCounters.wallUSec;
+}
+
+void PerfCounters::printCounters(std::ostream &outputStream, const char *phaseName)
+{
+    outputStream << phaseName << ": " << (wallUSec / 1000000) << "." << setw(6) << setfill('0')
+                    << (wallUSec % 1000000) << setfill(' ') << " seconds";
+
+    //Without counters only wall-clock time is known
+    if(openedMask == 0)
+    {
+        outputStream << " (hardware counters unavailable)" << endl;
+        return;
+    }
+    const char *counterNames[NUM_COUNTERS] = {"cycles", "instructions", "LLC misses", "dTLB misses", "branch misses"};
+    for(unsigned int index = 0; index < NUM_COUNTERS; index++)
+    {
+        if(openedMask & (1u << index))
+        {
+            outputStream << ", " << counterValues[index] << " " << counterNames[index];
+        }
+        else
+        {
+            outputStream << ", no " << counterNames[index];
+        }
+    }
+    if((openedMask & 3u) == 3u && counterValues[0] > 0)
+    {
+        outputStream << ", " << fixed << setprecision(2) << ((double)counterValues[1] / counterValues[0]) << " IPC";
+        outputStream.unsetf(ios::floatfield);
+        outputStream << setprecision(6);
+    }
+    outputStream << endl;
+}
+
+ScanResult::ScanResult()
+{
+    //Set number of matches and prefilter counters to zero
+    numMatches = 0;
+    numWindows = 0;
+    prefilterRejects = 0;
+    prefilterPasses = 0;
+}
+
+void ScanResult::addMatch(unsigned long long matchPosition, unsigned long long matchKey)
+{
+    //Keep position and key of match for printing and reporting
+    if(keepAllFlag || matchPositions.size() < MAX_PRINTED_MATCHES)
+    {
+        matchPositions.push_back(matchPosition);
+        matchKeys.push_back(matchKey);
+    }
+
+    //Increment number of found matches
+    numMatches += 1;
+}
+
+void ScanResult::mergeResult(const ScanResult &nextResult)
+{
+    //Append kept matches of following range, up to printed matches unless all are kept
+    unsigned long long keepCount = nextResult.matchPositions.size();
+    if(!keepAllFlag)
+    {
+        unsigned long long roomCount = (matchPositions.size() < MAX_PRINTED_MATCHES)
+                                            ? MAX_PRINTED_MATCHES - matchPositions.size() : 0;
+        keepCount = min(keepCount, roomCount);
+    }
+    matchPositions.insert(matchPositions.end(), nextResult.matchPositions.begin(),
+                            nextResult.matchPositions.begin() + keepCount);
+    matchKeys.insert(matchKeys.end(), nextResult.matchKeys.begin(), nextResult.matchKeys.begin() + keepCount);
+
+    //Add counters of each scan thread
+    if(threadCounters.size() < nextResult.threadCounters.size())
+    {
+        threadCounters.resize(nextResult.threadCounters.size());
+    }
+    for(unsigned int index = 0; index < nextResult.threadCounters.size(); index++)
+    {
+        threadCounters[index].addCounters(nextResult.threadCounters[index]);
+    }
+
+    //Add number of matches and prefilter counters
+    numMatches += nextResult.numMatches;
+    numWindows += nextResult.numWindows;
+    prefilterRejects += nextResult.prefilterRejects;
+    prefilterPasses += nextResult.prefilterPasses;
+}
+
+void ScanResult::trimMatches(unsigned long long keepCount)
+{
+    //Count of matches is unchanged, only their positions and keys are dropped
+    if(matchPositions.size() > keepCount)
+    {
+        matchPositions.resize(keepCount);
+        matchKeys.resize(keepCount);
+    }
+}
+
+FastaReader::FastaReader()
+{
+    //Set reader to empty
+    sequenceBuffer = NULL;
+    bufferBytes = 0;
+    sequenceLength = 0;
+    fileData = NULL;
+    fileLength = 0;
+    mappedFlag = false;
+    streamBuffer = NULL;
+    streamIndex = 0;
+    streamLength = 0;
+    headerFlag = false;
+    nameFlag = false;
+    lineStartFlag = true;
+    streamPosition = 0;
+}
+
+FastaReader::~FastaReader()
+{
+    //Deallocate sequence and stream buffers and release file contents
+    PagePolicy::releaseBuffer(sequenceBuffer, bufferBytes);
+    delete[] streamBuffer;
+    closeFile();
+}
+
+bool FastaReader::readFile(FILE *filePointer)
+{
+    //Map file contents
+    if(!openFile(filePointer))
+    {
+        return false;
+    }
+
+    //File length bounds sequence length, so buffer is allocated once
+    //Scan reads it at random offsets from every thread, so it follows page policy
+    PagePolicy::releaseBuffer(sequenceBuffer, bufferBytes);
+    bufferBytes = fileLength + 1;
+    sequenceBuffer = (char *)PagePolicy::allocateBuffer(bufferBytes);
+
+    //Copy sequence characters in single pass
+    recordStarts.clear();
+    recordNames.clear();
+    sequenceLength = scanFile(sequenceBuffer);
+    sequenceBuffer[sequenceLength] = '\0';
+
+    finishRecords();
+
+    //Release file contents, only sequence buffer is kept
+    closeFile();
+    return true;
+}
+
+unsigned long long FastaReader::countFile(FILE *filePointer)
+{
+    //Initialize function/variables
+    unsigned long long numBases = 0;
+
+    //Map file contents and count sequence characters
+    if(openFile(filePointer))
+    {
+        numBases = scanFile(NULL);
+        closeFile();
+    }
+    return numBases;
+}
+
+bool FastaReader::openFile(FILE *filePointer)
+{
+    //Initialize function/variables
+    struct stat fileStats;
+    int fileDescriptor = fileno(filePointer);
+
+    //Release any earlier contents
+    closeFile();
+
+    //Try to map whole file
+    if(fstat(fileDescriptor, &fileStats) == 0 && S_ISREG(fileStats.st_mode))
+    {
+        fileLength = (unsigned long long)fileStats.st_size;
+        if(fileLength == 0)
+        {
+            return true;
+        }
+        void *mappedData = mmap(NULL, fileLength, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if(mappedData != MAP_FAILED)
+        {
+            //File is read front to back once
+            madvise(mappedData, fileLength, MADV_SEQUENTIAL);
+            fileData = (char *)mappedData;
+            mappedFlag = true;
+            return true;
+        }
+    }
+
+    //Mapping not possible, read whole file into memory instead
+    unsigned long long capacity = 1 << 16;
+    fileLength = 0;
+    fileData = new char[capacity];
+    fseek(filePointer, 0, SEEK_SET);
+    size_t numRead = fread(fileData, 1, capacity, filePointer);
+    while(numRead > 0)
+    {
+        fileLength += numRead;
+
+        //Double buffer when full
+        if(fileLength == capacity)
+        {
+            char *newData = new char[capacity * 2];
+            memcpy(newData, fileData, fileLength);
+            delete[] fileData;
+            fileData = newData;
+            capacity *= 2;
+        }
+        numRead = fread(fileData + fileLength, 1, capacity - fileLength, filePointer);
+    }
+    return true;
+}
+
+void FastaReader::closeFile()
+{
+    //Unmap or deallocate file contents
+    if(mappedFlag)
+    {
+        munmap(fileData, fileLength);
+    }
+    else
+    {
+        delete[] fileData;
+    }
+    fileData = NULL;
+    fileLength = 0;
+    mappedFlag = false;
+}
+
+unsigned long long FastaReader::readChunk(FILE *filePointer, char *destBuffer, unsigned long long maxLength)
+{
+    //Initialize function/variables
+    unsigned long long numBases = 0;
+    if(streamBuffer == NULL)
+    {
+        streamBuffer = new char[STREAM_BLOCK];
+    }
+
+    //Loop until chunk is full or file runs out
+    while(numBases < maxLength)
+    {
+        //Refill raw block when used up
+        if(streamIndex == streamLength)
+        {
+            streamLength = (unsigned int)fread(streamBuffer, 1, STREAM_BLOCK, filePointer);
+            streamIndex = 0;
+            if(streamLength == 0)
+            {
+                break;
+            }
+        }
+
+        //Header lines begin with '>' and run to next newline, even across blocks
+        char wkgChar = streamBuffer[streamIndex];
+        streamIndex++;
+        if(wkgChar == '\n')
+        {
+            headerFlag = false;
+            lineStartFlag = true;
+        }
+        else if(lineStartFlag && wkgChar == '>')
+        {
+            //Header may run past end of block, so name is collected one character at a time
+            unsigned long long newBases = startRecord(destBuffer, numBases, streamPosition - numBases, NULL, NULL);
+            streamPosition += newBases - numBases;
+            numBases = newBases;
+            headerFlag = true;
+            nameFlag = true;
+            lineStartFlag = false;
+        }
+        else if(headerFlag)
+        {
+            //Name ends at first space, rest of header is skipped
+            nameFlag = nameFlag && (wkgChar != ' ' && wkgChar != '\t' && wkgChar != '\r');
+            if(nameFlag)
+            {
+                recordNames.back() += wkgChar;
+            }
+        }
+        else
+        {
+            lineStartFlag = false;
+
+            //Always store character, only advance past alphabet characters
+            destBuffer[numBases] = wkgChar;
+            unsigned int alphaFlag = ((unsigned char)(wkgChar - 'A') < 26);
+            numBases += alphaFlag;
+            streamPosition += alphaFlag;
+        }
+    }
+
+    //Return number of sequence characters copied
+    return numBases;
+}
+
+bool FastaReader::readQueries(FILE *filePointer, unsigned int queryLength)
+{
+    //Read every record into sequence buffer
+    if(!readFile(filePointer))
+    {
+        return false;
+    }
+
+    //Slide whole queries of each record down over separators and leftovers
+    unsigned long long destIndex = 0;
+    queryRecords.clear();
+    for(unsigned int recordIndex = 0; recordIndex < recordStarts.size(); recordIndex++)
+    {
+        unsigned long long recordStart = recordStarts[recordIndex];
+        unsigned long long recordEnd = sequenceLength;
+        if(recordIndex + 1 < recordStarts.size())
+        {
+            recordEnd = recordStarts[recordIndex + 1] - (recordStarts[recordIndex + 1] > recordStart);
+        }
+        unsigned long long numWhole = (recordEnd - recordStart) / queryLength;
+        memmove(sequenceBuffer + destIndex, sequenceBuffer + recordStart, numWhole * queryLength);
+        queryRecords.insert(queryRecords.end(), numWhole, recordIndex);
+        destIndex += numWhole * queryLength;
+    }
+    sequenceLength = destIndex;
+    sequenceBuffer[sequenceLength] = '\0';
+    return true;
+}
+
+unsigned long long FastaReader::startRecord(char *destBuffer, unsigned long long seqIndex, unsigned long long seqOffset,
+                                                const char *nameStart, const char *nameEnd)
+{
+    //Separate from earlier record so no window crosses into this one
+    if(seqOffset + seqIndex > 0)
+    {
+        destBuffer[seqIndex] = RECORD_SEPARATOR;
+        seqIndex++;
+    }
+
+    //Name runs from after '>' to first space
+    const char *wkgPtr = nameStart;
+    while(wkgPtr < nameEnd && *wkgPtr != ' ' && *wkgPtr != '\t' && *wkgPtr != '\r')
+    {
+        wkgPtr++;
+    }
+    recordStarts.push_back(seqOffset + seqIndex);
+    recordNames.push_back(string(nameStart, wkgPtr - nameStart));
+    return seqIndex;
+}
+
+void FastaReader::finishRecords()
+{
+    //Sequence before first header belongs to unnamed record
+    if(recordStarts.empty() || recordStarts[0] != 0)
+    {
+        recordStarts.insert(recordStarts.begin(), 0);
+        recordNames.insert(recordNames.begin(), string());
+    }
+}
+
+unsigned int FastaReader::findRecord(unsigned long long seqIndex)
+{
+    //Last record starting at or before index
+    unsigned int recordIndex = (unsigned int)(upper_bound(recordStarts.begin(), recordStarts.end(), seqIndex)
+                                                - recordStarts.begin());
+    return (recordIndex > 0) ? recordIndex - 1 : 0;
+}
+
+void QueryCatalog::readCatalog(FILE *queryFile)
+{
+    //Initialize function/variables
+    FastaReader queryReader;
+    KmerEncoder catalogEncoder;
+    vector< pair<unsigned long long, unsigned int> > queryPairs;
+
+    //Encode each whole query with its record, skip queries outside NATCG
+    queryReader.readQueries(queryFile, QUERY_LENGTH);
+    for(unsigned long long index = 0; index + QUERY_LENGTH <= queryReader.sequenceLength; index += QUERY_LENGTH)
+    {
+        bool validFlag = true;
+        unsigned long long queryKey = catalogEncoder.encodeWindow(queryReader.sequenceBuffer, index, validFlag);
+        if(validFlag)
+        {
+            queryPairs.push_back(make_pair(queryKey, queryReader.queryRecords[index / QUERY_LENGTH]));
+        }
+    }
+
+    //Sort by radix value, duplicates keep file order
+    sort(queryPairs.begin(), queryPairs.end());
+    keyArray.resize(queryPairs.size());
+    recordArray.resize(queryPairs.size());
+    for(unsigned long long index = 0; index < queryPairs.size(); index++)
+    {
+        keyArray[index] = queryPairs[index].first;
+        recordArray[index] = queryPairs[index].second;
+    }
+    recordNames = queryReader.recordNames;
+}
+
+unsigned int QueryCatalog::findQuery(unsigned long long queryKey)
+{
+    //Binary search for first query holding radix value
+    vector<unsigned long long>::iterator keyPtr = lower_bound(keyArray.begin(), keyArray.end(), queryKey);
+    if(keyPtr == keyArray.end() || *keyPtr != queryKey)
+    {
+        return INVALID_QUERY;
+    }
+    return recordArray[keyPtr - keyArray.begin()];
+}
+
+MatchReport::MatchReport()
+{
+    //Set report to closed
+    reportFile = NULL;
+    numWritten = 0;
+    approxTable = NULL;
+}
+
+MatchReport::~MatchReport()
+{
+    //Close report file if still open
+    closeReport();
+}
+
+bool MatchReport::openReport(const char *reportPath, FILE *queryFile)
+{
+    //Read query names before first match is written
+    reportFile = fopen(reportPath, "w");
+    if(reportFile != NULL && queryFile != NULL)
+    {
+        queryCatalog.readCatalog(queryFile);
+    }
+    return reportFile != NULL;
+}
+
+void MatchReport::writeMatches(const ScanResult &scanResult, FastaReader &genomeReader)
+{
+    for(unsigned long long matchIndex = 0; matchIndex < scanResult.matchPositions.size() && reportFile != NULL; matchIndex++)
+    {
+        unsigned long long matchPosition = scanResult.matchPositions[matchIndex];
+        unsigned int genomeRecord = genomeReader.findRecord(matchPosition);
+        unsigned long long matchKey = scanResult.matchKeys[matchIndex];
+        char matchStrand = '+';
+
+        //Near matches are reported against query they are close to
+        if(approxTable != NULL)
+        {
+            matchKey = approxTable->findNeighbour(matchKey);
+        }
+        unsigned int queryRecord = queryCatalog.findQuery(matchKey);
+
+        //Window not found forward matched reverse complement of query
+        if(queryRecord == INVALID_QUERY)
+        {
+            if(reportEncoder.canonicalFlag)
+            {
+                queryRecord = queryCatalog.findQuery(reportEncoder.reverseComplement(matchKey));
+            }
+            matchStrand = (queryRecord == INVALID_QUERY) ? '?' : '-';
+        }
+
+        //Unnamed records are written by number, queries not in catalog as '-' with unknown strand
+        if(genomeReader.recordNames[genomeRecord].empty())
+        {
+            fprintf(reportFile, "%u\t", genomeRecord);
+        }
+        else
+        {
+            fprintf(reportFile, "%s\t", genomeReader.recordNames[genomeRecord].c_str());
+        }
+        fprintf(reportFile, "%llu\t", matchPosition - genomeReader.recordStarts[genomeRecord]);
+        if(queryRecord == INVALID_QUERY)
+        {
+            fprintf(reportFile, "-\t%c\n", matchStrand);
+        }
+        else if(queryCatalog.recordNames[queryRecord].empty())
+        {
+            fprintf(reportFile, "%u\t%c\n", queryRecord, matchStrand);
+        }
+        else
+        {
+            fprintf(reportFile, "%s\t%c\n", queryCatalog.recordNames[queryRecord].c_str(), matchStrand);
+        }
+        numWritten += 1;
+    }
+}
+
+bool MatchReport::closeReport()
+{
+    //Check for write errors held back by buffering
+    bool writeFlag = (reportFile != NULL) && !ferror(reportFile);
+    if(reportFile != NULL)
+    {
+        writeFlag = (fclose(reportFile) == 0) && writeFlag;
+        reportFile = NULL;
+    }
+    return writeFlag;
+}
+
+unsigned long long FastaReader::scanFile(char *destBuffer)
+{
+    //Initialize function/variables
+    unsigned long long numBases = 0;
+    const char *wkgPtr = fileData;
+    const char *endPtr = fileData + fileLength;
+
+    //Loop over every line of file
+    while(wkgPtr < endPtr)
+    {
+        //Find end of current line
+        const char *lineEnd = (const char *)memchr(wkgPtr, '\n', endPtr - wkgPtr);
+        if(lineEnd == NULL)
+        {
+            lineEnd = endPtr;
+        }
+
+        //Header lines start new record when filling buffer
+        if(*wkgPtr == '>')
+        {
+            if(destBuffer != NULL)
+            {
+                numBases = startRecord(destBuffer, numBases, 0, wkgPtr + 1, lineEnd);
+            }
+        }
+        else
+        {
+            if(destBuffer != NULL)
+            {
+                //Always store character, only advance past alphabet characters
+                for(; wkgPtr < lineEnd; wkgPtr++)
+                {
+                    destBuffer[numBases] = *wkgPtr;
+                    numBases += ((unsigned char)(*wkgPtr - 'A') < 26);
+                }
+            }
+            else
+            {
+                for(; wkgPtr < lineEnd; wkgPtr++)
+                {
+                    numBases += ((unsigned char)(*wkgPtr - 'A') < 26);
+                }
+            }
+        }
+
+        //Move past newline
+        wkgPtr = lineEnd + 1;
+    }
+
+    //Return number of sequence characters
+    return numBases;
+}
+
+Queries_Sorted::Queries_Sorted()
+{
+    //Set all values to defaults
+    queryFilePointer = NULL;
+    numQueries = 0;
+    keyArray = NULL;
+    numInvalid = 0;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+}
+
+Queries_Sorted::Queries_Sorted(FILE *queryFile)
+{
+    //Set all values to provided data where applicable
+    queryFilePointer = queryFile;
+    numQueries = 0;
+    keyArray = NULL;
+    numInvalid = 0;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+}
+
+Queries_Sorted::~Queries_Sorted()
+{
+    //Deallocate key array and prefilter
+    free(keyArray);
+    delete prefilter;
+}
+
+bool Queries_Sorted::searchHash(char *genomeString, unsigned int srcIndex)
+{
+    //Encode all 16 characters and search using full key
+    bool validFlag = true;
+    unsigned long long windowKey = queryEncoder.encodeWindow(genomeString, srcIndex, validFlag);
+    return validFlag && searchKey(queryEncoder.canonicalKey(windowKey));
+}
+
+bool Queries_Sorted::searchKey(unsigned long long windowKey)
+{
+    //Initialize working index at root
+    unsigned long long wkgIndex = 1;
+
+    //Descend one level per step, left on smaller or equal, right on larger
+    //Turn is chosen without a branch, loop runs to a leaf whose depth varies by at most one
+    while(wkgIndex <= numQueries)
+    {
+        //Eight keys per cache line, fetch line holding descendants three levels down
+        __builtin_prefetch(keyArray + (wkgIndex * 8));
+        wkgIndex = (2 * wkgIndex) + (keyArray[wkgIndex] < windowKey);
+    }
+
+    //Undo right turns taken after last left turn to find smallest key not below window key
+    wkgIndex >>= __builtin_ffsll(~wkgIndex);
+
+    //Index 0 means every key is below window key
+    return (wkgIndex != 0) && (keyArray[wkgIndex] == windowKey);
+}
+
+void Queries_Sorted::prefetchKey(unsigned long long)
+{
+    //Nothing to fetch before search knows its path
+}
+
+unsigned int Queries_Sorted::fillHashes(bool timerFlag)
+{
+    //Initialize variables
+    struct timeval fillStartTime, fillEndTime;
+    vector<unsigned long long> sortedKeys;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Encode queries, sort and remove duplicates
+    unsigned int numDuplicates = collectUniqueKeys(queryFilePointer, queryEncoder, sortedKeys, numInvalid);
+    numQueries = (unsigned int)sortedKeys.size();
+
+    //Allocate array aligned so keys 8k to 8k+7 share a cache line
+    void *keyMemory = NULL;
+    free(keyArray);
+    keyArray = NULL;
+    if(posix_memalign(&keyMemory, 64, ((size_t)numQueries + 1) * sizeof(unsigned long long)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    keyArray = (unsigned long long *)keyMemory;
+    keyArray[0] = 0;
+    layoutKeys(sortedKeys.data(), 0, 1);
+
+    //Build prefilter over distinct queries
+    if(prefilterRate > 0.0)
+    {
+        delete prefilter;
+        prefilter = new BloomFilter(numQueries, prefilterRate);
+        for(unsigned int index = 0; index < numQueries; index++)
+        {
+            prefilter->addKey(sortedKeys[index]);
+        }
+    }
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the sorted array");
+    }
+
+    return numDuplicates;
+}
+
+unsigned int Queries_Sorted::layoutKeys(const unsigned long long *sortedKeys, unsigned int sortedIndex,
+                                            unsigned int arrayIndex)
+{
+    //In-order walk of implicit tree hands out sorted keys smallest first
+    if(arrayIndex <= numQueries)
+    {
+        sortedIndex = layoutKeys(sortedKeys, sortedIndex, 2 * arrayIndex);
+        keyArray[arrayIndex] = sortedKeys[sortedIndex];
+        sortedIndex++;
+        sortedIndex = layoutKeys(sortedKeys, sortedIndex, (2 * arrayIndex) + 1);
+    }
+
+    //Return next sorted key to hand out
+    return sortedIndex;
+}
+
+unsigned long long Queries_Sorted::memoryUsage()
+{
+    //Count key array plus unused slot 0
+    return (((unsigned long long)numQueries + 1) * sizeof(unsigned long long))
+            + ((prefilter != NULL) ? prefilter->memoryUsage() : 0);
+}
+
+Queries_Perfect::Queries_Perfect()
+{
+    //Set all values to defaults
+    queryFilePointer = NULL;
+    numQueries = 0;
+    numInvalid = 0;
+    numBuckets = 0;
+    numSlots = 0;
+    pilotValues = NULL;
+    packedKeys = NULL;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+}
+
+Queries_Perfect::Queries_Perfect(FILE *queryFile)
+{
+    //Set all values to provided data where applicable
+    queryFilePointer = queryFile;
+    numQueries = 0;
+    numInvalid = 0;
+    numBuckets = 0;
+    numSlots = 0;
+    pilotValues = NULL;
+    packedKeys = NULL;
+    prefilterRate = 0.0;
+    prefilter = NULL;
+}
+
+Queries_Perfect::~Queries_Perfect()
+{
+    //Deallocate pilot and key arrays and prefilter
+    delete[] pilotValues;
+    PagePolicy::releaseBuffer(packedKeys, ((unsigned long long)numQueries * PACKED_KEY_BYTES) + 8);
+    delete prefilter;
+}
+
+bool Queries_Perfect::searchHash(char *genomeString, unsigned int srcIndex)
+{
+    //Encode all 16 characters and search using full key
+    bool validFlag = true;
+    unsigned long long windowKey = queryEncoder.encodeWindow(genomeString, srcIndex, validFlag);
+    return validFlag && searchKey(queryEncoder.canonicalKey(windowKey));
+}
+
+unsigned int Queries_Perfect::mixRange(unsigned long long windowKey, unsigned long long seedValue,
+                                        unsigned int rangeSize)
+{
+    //Mix key with seed so bucket and slot hashes are independent
+    unsigned long long mixValue = windowKey + seedValue;
+    mixValue = (mixValue ^ (mixValue >> 30)) * 0xBF58476D1CE4E5B9ull;
+    mixValue = (mixValue ^ (mixValue >> 27)) * 0x94D049BB133111EBull;
+    mixValue ^= mixValue >> 31;
+
+    //Scale hash to range without a division
+    return (unsigned int)(((unsigned __int128)mixValue * rangeSize) >> 64);
+}
+
+unsigned int Queries_Perfect::pilotSlot(unsigned long long windowKey, unsigned int pilotValue)
+{
+    //Pilot changes seed of slot hash only, bucket stays fixed
+    return mixRange(windowKey, SLOT_SEED * (pilotValue + 1), numSlots);
+}
+
+unsigned int Queries_Perfect::findIndex(unsigned long long windowKey)
+{
+    //Pilot of key's bucket gives its slot, slots past numQueries are moved into gaps below
+    unsigned int slotIndex = pilotSlot(windowKey, pilotValues[mixRange(windowKey, BUCKET_SEED, numBuckets)]);
+    if(slotIndex >= numQueries)
+    {
+        slotIndex = remapSlots[slotIndex - numQueries];
+    }
+    return slotIndex;
+}
+
+bool Queries_Perfect::searchKey(unsigned long long windowKey)
+{
+    //Compare key stored at perfect hash index
+    if(numQueries > 0)
+    {
+        unsigned long long storedKey;
+        memcpy(&storedKey, packedKeys + ((unsigned long long)findIndex(windowKey) * PACKED_KEY_BYTES), sizeof(storedKey));
+        if((storedKey & PACKED_KEY_MASK) == windowKey)
+        {
+            return true;
+        }
+    }
+
+    //Queries of unplaced buckets are kept apart, almost always none
+    return !fallbackKeys.empty() && binary_search(fallbackKeys.begin(), fallbackKeys.end(), windowKey);
+}
+
+void Queries_Perfect::prefetchKey(unsigned long long windowKey)
+{
+    //Pilots are small enough to stay cached, so slot can be found now and its key loaded ahead
+    if(numQueries > 0)
+    {
+        __builtin_prefetch(packedKeys + ((unsigned long long)findIndex(windowKey) * PACKED_KEY_BYTES));
+    }
+}
+
+unsigned int Queries_Perfect::fillHashes(bool timerFlag)
+{
+    //Initialize variables
+    struct timeval fillStartTime, fillEndTime;
+    vector<unsigned long long> sortedKeys;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Encode queries, sort and remove duplicates
+    unsigned int numDuplicates = collectUniqueKeys(queryFilePointer, queryEncoder, sortedKeys, numInvalid);
+    numQueries = (unsigned int)sortedKeys.size();
+
+    //Size buckets and slots from number of distinct queries
+    numBuckets = (numQueries / PERFECT_BUCKET_KEYS) + 1;
+    numSlots = (unsigned int)(numQueries / PERFECT_FILL) + 1;
+    delete[] pilotValues;
+    pilotValues = new unsigned short[numBuckets]();
+
+    //Group queries by bucket with a counting sort
+    vector<unsigned int> bucketStarts(numBuckets + 1, 0);
+    for(unsigned int index = 0; index < numQueries; index++)
+    {
+        bucketStarts[mixRange(sortedKeys[index], BUCKET_SEED, numBuckets) + 1]++;
+    }
+    unsigned int largestBucket = 0;
+    for(unsigned int bucketIndex = 0; bucketIndex < numBuckets; bucketIndex++)
+    {
+        largestBucket = max(largestBucket, bucketStarts[bucketIndex + 1]);
+        bucketStarts[bucketIndex + 1] += bucketStarts[bucketIndex];
+    }
+    vector<unsigned long long> bucketKeys(numQueries);
+    vector<unsigned int> fillCounts(bucketStarts.begin(), bucketStarts.end() - 1);
+    for(unsigned int index = 0; index < numQueries; index++)
+    {
+        bucketKeys[fillCounts[mixRange(sortedKeys[index], BUCKET_SEED, numBuckets)]++] = sortedKeys[index];
+    }
+
+    //Place largest buckets first while most slots are still free
+    vector<unsigned int> bucketOrder(numBuckets);
+    vector<unsigned int> sizeStarts(largestBucket + 2, 0);
+    for(unsigned int bucketIndex = 0; bucketIndex < numBuckets; bucketIndex++)
+    {
+        sizeStarts[largestBucket - (bucketStarts[bucketIndex + 1] - bucketStarts[bucketIndex]) + 1]++;
+    }
+    for(unsigned int sizeIndex = 0; sizeIndex <= largestBucket; sizeIndex++)
+    {
+        sizeStarts[sizeIndex + 1] += sizeStarts[sizeIndex];
+    }
+    for(unsigned int bucketIndex = 0; bucketIndex < numBuckets; bucketIndex++)
+    {
+        bucketOrder[sizeStarts[largestBucket - (bucketStarts[bucketIndex + 1] - bucketStarts[bucketIndex])]++] = bucketIndex;
+    }
+
+    //Try pilots until every query of bucket lands on its own free slot
+    vector<unsigned long long> slotKeys(numSlots, 0);
+    vector<bool> takenSlots(numSlots, false);
+    vector<unsigned int> bucketSlots(largestBucket);
+    fallbackKeys.clear();
+    for(unsigned int orderIndex = 0; orderIndex < numBuckets; orderIndex++)
+    {
+        unsigned int bucketIndex = bucketOrder[orderIndex];
+        unsigned int bucketSize = bucketStarts[bucketIndex + 1] - bucketStarts[bucketIndex];
+        if(bucketSize == 0)
+        {
+            break;
+        }
+
+        bool placedFlag = false;
+        for(unsigned int pilotValue = 0; pilotValue <= MAX_PILOT && !placedFlag; pilotValue++)
+        {
+            placedFlag = true;
+            for(unsigned int keyIndex = 0; keyIndex < bucketSize && placedFlag; keyIndex++)
+            {
+                bucketSlots[keyIndex] = pilotSlot(bucketKeys[bucketStarts[bucketIndex] + keyIndex], pilotValue);
+                placedFlag = !takenSlots[bucketSlots[keyIndex]];
+                for(unsigned int prevIndex = 0; prevIndex < keyIndex && placedFlag; prevIndex++)
+                {
+                    placedFlag = bucketSlots[prevIndex] != bucketSlots[keyIndex];
+                }
+            }
+            if(placedFlag)
+            {
+                pilotValues[bucketIndex] = (unsigned short)pilotValue;
+                for(unsigned int keyIndex = 0; keyIndex < bucketSize; keyIndex++)
+                {
+                    takenSlots[bucketSlots[keyIndex]] = true;
+                    slotKeys[bucketSlots[keyIndex]] = bucketKeys[bucketStarts[bucketIndex] + keyIndex];
+                }
+            }
+        }
+
+        //Bucket with no pilot keeps its queries aside
+        if(!placedFlag)
+        {
+            fallbackKeys.insert(fallbackKeys.end(), bucketKeys.begin() + bucketStarts[bucketIndex],
+                                    bucketKeys.begin() + bucketStarts[bucketIndex + 1]);
+        }
+    }
+    sort(fallbackKeys.begin(), fallbackKeys.end());
+
+    //Point each slot past numQueries at next free slot below it
+    remapSlots.assign(numSlots - numQueries, 0);
+    unsigned int freeIndex = 0;
+    for(unsigned int slotIndex = numQueries; slotIndex < numSlots; slotIndex++)
+    {
+        if(takenSlots[slotIndex])
+        {
+            while(takenSlots[freeIndex])
+            {
+                freeIndex++;
+            }
+            remapSlots[slotIndex - numQueries] = freeIndex++;
+        }
+    }
+
+    //Store each key at its index, eight bytes of padding let last key be read as a word
+    PagePolicy::releaseBuffer(packedKeys, ((unsigned long long)numQueries * PACKED_KEY_BYTES) + 8);
+    packedKeys = (unsigned char *)PagePolicy::allocateBuffer(((unsigned long long)numQueries * PACKED_KEY_BYTES) + 8);
+    memset(packedKeys, 0xFF, ((unsigned long long)numQueries * PACKED_KEY_BYTES) + 8);
+    for(unsigned int slotIndex = 0; slotIndex < numSlots; slotIndex++)
+    {
+        if(takenSlots[slotIndex])
+        {
+            unsigned int keyIndex = (slotIndex < numQueries) ? slotIndex : remapSlots[slotIndex - numQueries];
+            memcpy(packedKeys + ((unsigned long long)keyIndex * PACKED_KEY_BYTES), &slotKeys[slotIndex], PACKED_KEY_BYTES);
+        }
+    }
+
+    //Build prefilter over distinct queries
+    if(prefilterRate > 0.0)
+    {
+        delete prefilter;
+        prefilter = new BloomFilter(numQueries, prefilterRate);
+        for(unsigned int index = 0; index < numQueries; index++)
+        {
+            prefilter->addKey(sortedKeys[index]);
+        }
+    }
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "build the perfect hash");
+    }
+
+    return numDuplicates;
+}
+
+double Queries_Perfect::hashBitsPerKey()
+{
+    //Pilots plus remapped slots, stored keys not counted
+    unsigned long long hashBits = ((unsigned long long)numBuckets * sizeof(unsigned short) * 8)
+                                    + (remapSlots.size() * sizeof(unsigned int) * 8);
+    return (double)hashBits / ((numQueries > 0) ? numQueries : 1);
+}
+
+unsigned long long Queries_Perfect::memoryUsage()
+{
+    //Count pilots, remapped slots, packed keys and fallback keys
+    return ((unsigned long long)numBuckets * sizeof(unsigned short))
+            + (remapSlots.size() * sizeof(unsigned int))
+            + ((unsigned long long)numQueries * PACKED_KEY_BYTES) + 8
+            + (fallbackKeys.size() * sizeof(unsigned long long))
+            + ((prefilter != NULL) ? prefilter->memoryUsage() : 0);
+}
+
+Queries_Bitmap::Queries_Bitmap()
+{
+    //Set all values to defaults
+    queryFilePointer = NULL;
+    numQueries = 0;
+    numInvalid = 0;
+    bitWords = NULL;
+    prefilter = NULL;
+    fillChunks();
+}
+
+Queries_Bitmap::Queries_Bitmap(FILE *queryFile)
+{
+    //Set all values to provided data where applicable
+    queryFilePointer = queryFile;
+    numQueries = 0;
+    numInvalid = 0;
+    bitWords = NULL;
+    prefilter = NULL;
+    fillChunks();
+}
+
+Queries_Bitmap::~Queries_Bitmap()
+{
+    //Deallocate bitmap
+    PagePolicy::releaseBuffer(bitWords, (bitWords != NULL) ? BITMAP_BYTES : 0);
+}
+
+void Queries_Bitmap::fillChunks()
+{
+    //Base-5 digits 1 to 4 become 2-bit codes 0 to 3, first digit lowest as in radix value
+    for(unsigned int chunkValue = 0; chunkValue < CHUNK_VALUES; chunkValue++)
+    {
+        unsigned int digitValue = chunkValue;
+        chunkBits[chunkValue] = 0;
+        for(unsigned int digitIndex = 0; digitIndex < 4; digitIndex++)
+        {
+            if(digitValue % 5 == 0)
+            {
+                chunkBits[chunkValue] |= CHUNK_HAS_N;
+            }
+            else
+            {
+                chunkBits[chunkValue] |= ((digitValue % 5) - 1) << (2 * digitIndex);
+            }
+            digitValue /= 5;
+        }
+    }
+}
+
+unsigned long long Queries_Bitmap::bitIndex(unsigned long long windowKey, bool &acgtFlag)
+{
+    //Split radix value into four blocks of four digits, divisions by constants become multiplies
+    unsigned int lowChunk = chunkBits[windowKey % CHUNK_VALUES];
+    windowKey /= CHUNK_VALUES;
+    unsigned int secondChunk = chunkBits[windowKey % CHUNK_VALUES];
+    windowKey /= CHUNK_VALUES;
+    unsigned int thirdChunk = chunkBits[windowKey % CHUNK_VALUES];
+    unsigned int highChunk = chunkBits[windowKey / CHUNK_VALUES];
+
+    acgtFlag = ((lowChunk | secondChunk | thirdChunk | highChunk) & CHUNK_HAS_N) == 0;
+    return (lowChunk & 0xFF) | ((secondChunk & 0xFF) << 8) | ((thirdChunk & 0xFF) << 16)
+            | ((unsigned long long)(highChunk & 0xFF) << 24);
+}
+
+bool Queries_Bitmap::searchHash(char *genomeString, unsigned int srcIndex)
+{
+    //Encode all 16 characters and search using full key
+    bool validFlag = true;
+    unsigned long long windowKey = queryEncoder.encodeWindow(genomeString, srcIndex, validFlag);
+    return validFlag && searchKey(queryEncoder.canonicalKey(windowKey));
+}
+
+bool Queries_Bitmap::searchKey(unsigned long long windowKey)
+{
+    bool acgtFlag;
+    unsigned long long keyBit = bitIndex(windowKey, acgtFlag);
+    if(acgtFlag)
+    {
+        return bitWords != NULL && ((bitWords[keyBit >> 6] >> (keyBit & 63)) & 1);
+    }
+
+    //Windows holding N are rare in genome and in queries
+    return !nKeys.empty() && binary_search(nKeys.begin(), nKeys.end(), windowKey);
+}
+
+void Queries_Bitmap::prefetchKey(unsigned long long windowKey)
+{
+    bool acgtFlag;
+    unsigned long long keyBit = bitIndex(windowKey, acgtFlag);
+    if(acgtFlag && bitWords != NULL)
+    {
+        __builtin_prefetch(&bitWords[keyBit >> 6]);
+    }
+}
+
+unsigned int Queries_Bitmap::fillHashes(bool timerFlag)
+{
+    //Initialize variables
+    struct timeval fillStartTime, fillEndTime;
+    unsigned int numDuplicates = 0;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Whole key space is mapped up front, untouched pages stay unbacked
+    if(bitWords == NULL)
+    {
+        bitWords = (unsigned long long *)PagePolicy::allocateBuffer(BITMAP_BYTES);
+    }
+
+    //Encode every query, duplicates are caught by bitmap
+    vector<unsigned long long> queryKeys;
+    readQueryKeys(queryFilePointer, queryEncoder, queryKeys, numInvalid);
+
+    //Set bit of each ACGT query, keep queries holding N apart
+    for(unsigned int index = 0; index < queryKeys.size(); index++)
+    {
+        bool acgtFlag;
+        unsigned long long keyBit = bitIndex(queryKeys[index], acgtFlag);
+        if(!acgtFlag)
+        {
+            nKeys.push_back(queryKeys[index]);
+        }
+        else if((bitWords[keyBit >> 6] >> (keyBit & 63)) & 1)
+        {
+            numDuplicates++;
+        }
+        else
+        {
+            bitWords[keyBit >> 6] |= 1ull << (keyBit & 63);
+            numQueries++;
+        }
+    }
+
+    //Sort and remove duplicate queries holding N
+    numDuplicates += removeDuplicateKeys(nKeys);
+    numQueries += (unsigned int)nKeys.size();
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the bitmap");
+    }
+
+    return numDuplicates;
+}
+
+unsigned long long Queries_Bitmap::memoryUsage()
+{
+    //Count full bitmap and N query keys
+    return ((bitWords != NULL) ? BITMAP_BYTES : 0) + (nKeys.size() * sizeof(unsigned long long));
+}
+
+Queries_Approx::Queries_Approx()
+{
+    //Set all values to defaults
+    queryFilePointer = NULL;
+    numQueries = 0;
+    numInvalid = 0;
+    firstStarts = NULL;
+    firstKeys = NULL;
+    lastStarts = NULL;
+    lastKeys = NULL;
+    prefilter = NULL;
+}
+
+Queries_Approx::Queries_Approx(FILE *queryFile)
+{
+    //Set all values to provided data where applicable
+    queryFilePointer = queryFile;
+    numQueries = 0;
+    numInvalid = 0;
+    firstStarts = NULL;
+    firstKeys = NULL;
+    lastStarts = NULL;
+    lastKeys = NULL;
+    prefilter = NULL;
+}
+
+Queries_Approx::~Queries_Approx()
+{
+    //Deallocate bucket and key arrays
+    delete[] firstStarts;
+    delete[] firstKeys;
+    delete[] lastStarts;
+    delete[] lastKeys;
+}
+
+bool Queries_Approx::searchHash(char *genomeString, unsigned int srcIndex)
+{
+    //Encode all 16 characters and search using full key
+    bool validFlag = true;
+    unsigned long long windowKey = queryEncoder.encodeWindow(genomeString, srcIndex, validFlag);
+    return validFlag && searchKey(windowKey);
+}
+
+bool Queries_Approx::searchKey(unsigned long long windowKey)
+{
+    //Any query close enough is a match
+    return findNeighbour(windowKey) != EMPTY_SLOT;
+}
+
+void Queries_Approx::prefetchKey(unsigned long long windowKey)
+{
+    //Both bucket starts are read by every lookup
+    __builtin_prefetch(&firstStarts[windowKey % HALF_PLACE_VALUE]);
+    __builtin_prefetch(&lastStarts[windowKey / HALF_PLACE_VALUE]);
+}
+
+unsigned long long Queries_Approx::findNeighbour(unsigned long long windowKey)
+{
+    //Split window into halves of 8 characters
+    unsigned long long firstHalf = windowKey % HALF_PLACE_VALUE;
+    unsigned long long lastHalf = windowKey / HALF_PLACE_VALUE;
+
+    //Queries sharing first half may differ once in last half
+    for(unsigned int index = firstStarts[firstHalf]; index < firstStarts[firstHalf + 1]; index++)
+    {
+        if(halfDistance(firstKeys[index] / HALF_PLACE_VALUE, lastHalf) <= 1)
+        {
+            return firstKeys[index];
+        }
+    }
+
+    //Queries sharing last half may differ once in first half
+    for(unsigned int index = lastStarts[lastHalf]; index < lastStarts[lastHalf + 1]; index++)
+    {
+        if(halfDistance(lastKeys[index] % HALF_PLACE_VALUE, firstHalf) <= 1)
+        {
+            return lastKeys[index];
+        }
+    }
+    return EMPTY_SLOT;
+}
+
+unsigned int Queries_Approx::fillHashes(bool timerFlag)
+{
+    //Initialize variables
+    struct timeval fillStartTime, fillEndTime;
+    vector<unsigned long long> sortedKeys;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    //Encode queries, sort and remove duplicates
+    unsigned int numDuplicates = collectUniqueKeys(queryFilePointer, queryEncoder, sortedKeys, numInvalid);
+    numQueries = (unsigned int)sortedKeys.size();
+
+    //Count queries in each bucket of both halves
+    delete[] firstStarts;
+    delete[] lastStarts;
+    firstStarts = new unsigned int[HALF_PLACE_VALUE + 1]();
+    lastStarts = new unsigned int[HALF_PLACE_VALUE + 1]();
+    for(unsigned int index = 0; index < numQueries; index++)
+    {
+        firstStarts[(sortedKeys[index] % HALF_PLACE_VALUE) + 1]++;
+        lastStarts[(sortedKeys[index] / HALF_PLACE_VALUE) + 1]++;
+    }
+
+    //Running totals give start of each bucket
+    for(unsigned int index = 0; index < HALF_PLACE_VALUE; index++)
+    {
+        firstStarts[index + 1] += firstStarts[index];
+        lastStarts[index + 1] += lastStarts[index];
+    }
+
+    //Place every query in its bucket of each half
+    delete[] firstKeys;
+    delete[] lastKeys;
+    firstKeys = new unsigned long long[numQueries];
+    lastKeys = new unsigned long long[numQueries];
+    vector<unsigned int> firstFill(firstStarts, firstStarts + HALF_PLACE_VALUE);
+    vector<unsigned int> lastFill(lastStarts, lastStarts + HALF_PLACE_VALUE);
+    for(unsigned int index = 0; index < numQueries; index++)
+    {
+        firstKeys[firstFill[sortedKeys[index] % HALF_PLACE_VALUE]++] = sortedKeys[index];
+        lastKeys[lastFill[sortedKeys[index] / HALF_PLACE_VALUE]++] = sortedKeys[index];
+    }
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the approximate index");
+    }
+
+    return numDuplicates;
+}
+
+unsigned long long Queries_Approx::memoryUsage()
+{
+    //Count both bucket arrays and both key arrays
+    return (2 * (HALF_PLACE_VALUE + 1) * sizeof(unsigned int))
+            + (2 * (unsigned long long)numQueries * sizeof(unsigned long long));
+}
+
+unsigned int halfDistance(unsigned long long oneHalf, unsigned long long otherHalf)
+{
+    //Compare one base-5 digit at a time, stop once two differ
+    unsigned int numDiffs = 0;
+    while(oneHalf != otherHalf && numDiffs < 2)
+    {
+        numDiffs += ((oneHalf % 5) != (otherHalf % 5));
+        oneHalf /= 5;
+        otherHalf /= 5;
+    }
+    return numDiffs;
+}
+
+template <class BaseTable, class TestTable>
+void timeSearchPair(BaseTable &baseTable, TestTable &testTable, const char *genomeString,
+                    unsigned long long numSubstrings, unsigned int numThreads,
+                    long long *searchUSecs, unsigned long long *searchMatches)
+{
+    //Keep fastest of several scans for each search, base table first
+    for(unsigned int repeatIndex = 0; repeatIndex < BENCH_REPEATS; repeatIndex++)
+    {
+        struct timeval benchStartTime, benchMidTime, benchEndTime;
+        gettimeofday( &benchStartTime, NULL);
+        searchMatches[0] = searchGenome(baseTable, genomeString, numSubstrings, numThreads).numMatches;
+        gettimeofday( &benchMidTime, NULL);
+        searchMatches[1] = searchGenome(testTable, genomeString, numSubstrings, numThreads).numMatches;
+        gettimeofday( &benchEndTime, NULL);
+
+        long long baseDiff = elapsedUSecs(benchStartTime, benchMidTime);
+        long long testDiff = elapsedUSecs(benchMidTime, benchEndTime);
+        if(repeatIndex == 0 || baseDiff < searchUSecs[0])
+        {
+            searchUSecs[0] = baseDiff;
+        }
+        if(repeatIndex == 0 || testDiff < searchUSecs[1])
+        {
+            searchUSecs[1] = testDiff;
+        }
+    }
+}
+
+void benchmarkApprox(Queries_Approx &approxTable, FILE *queryFile, const char *genomeString,
+                    unsigned long long numSubstrings, unsigned int numThreads)
+{
+    //Exact table over same queries for comparison
+    Queries_FlatHT exactTable = Queries_FlatHT(queryFile, findTableSize(countQueries(queryFile), DEFAULT_LOAD_FACTOR));
+    exactTable.fillHashes(false);
+
+    long long searchUSecs[2];
+    unsigned long long searchMatches[2];
+    timeSearchPair(exactTable, approxTable, genomeString, numSubstrings, numThreads, searchUSecs, searchMatches);
+    long long exactUSec = searchUSecs[0];
+    long long approxUSec = searchUSecs[1];
+    unsigned long long exactMatches = searchMatches[0];
+    unsigned long long approxMatches = searchMatches[1];
+
+    //Report throughput of both searches in windows per second
+    double exactRate = numSubstrings / ((exactUSec > 0 ? exactUSec : 1) / 1000000.0);
+    double approxRate = numSubstrings / ((approxUSec > 0 ? approxUSec : 1) / 1000000.0);
+    cout << "Exact search: " << exactMatches << " matches, " << (unsigned long long)exactRate << " windows/s" << endl;
+    cout << "Approximate search: " << approxMatches << " matches, " << (unsigned long long)approxRate
+            << " windows/s (" << setprecision(3) << (exactRate / approxRate) << "x exact cost)" << endl;
+}
+
+void benchmarkPerfect(Queries_Perfect &perfectTable, FILE *queryFile, const char *genomeString,
+                    unsigned long long numSubstrings, unsigned int numThreads)
+{
+    //Chained table over same queries for comparison
+    Queries_HT chainTable = Queries_HT(queryFile, findTableSize(countQueries(queryFile), DEFAULT_LOAD_FACTOR));
+    chainTable.queryEncoder.canonicalFlag = perfectTable.queryEncoder.canonicalFlag;
+    chainTable.fillHashes(false);
+
+    long long searchUSecs[2];
+    unsigned long long searchMatches[2];
+    timeSearchPair(chainTable, perfectTable, genomeString, numSubstrings, numThreads, searchUSecs, searchMatches);
+    long long chainUSec = searchUSecs[0];
+    long long perfectUSec = searchUSecs[1];
+    unsigned long long chainMatches = searchMatches[0];
+    unsigned long long perfectMatches = searchMatches[1];
+
+    //Report size and lookup throughput of both indexes
+    double chainRate = numSubstrings / ((chainUSec > 0 ? chainUSec : 1) / 1000000.0);
+    double perfectRate = numSubstrings / ((perfectUSec > 0 ? perfectUSec : 1) / 1000000.0);
+    unsigned int numKeys = (perfectTable.numQueries > 0) ? perfectTable.numQueries : 1;
+    cout << "Chained table: " << chainMatches << " matches, " << (unsigned long long)chainRate << " lookups/s, "
+            << setprecision(4) << (chainTable.memoryUsage() * 8.0 / numKeys) << " bits per key" << endl;
+    cout << "Perfect hash: " << perfectMatches << " matches, " << (unsigned long long)perfectRate << " lookups/s, "
+            << (perfectTable.memoryUsage() * 8.0 / numKeys) << " bits per key ("
+            << perfectTable.hashBitsPerKey() << " without keys), "
+            << setprecision(3) << (perfectRate / chainRate) << "x chained speed" << endl;
+    cout << setprecision(6);
+}
+
+WorkloadGenerator::WorkloadGenerator(unsigned long long seed)
+{
+    //Set small workload, callers raise sizes as needed
+    seedValue = seed;
+    genomeLength = 1000000;
+    numQueries = 1000;
+    plantedFraction = 0.5;
+    duplicateFraction = 0.0;
+    nRunRate = 0.0;
+    nRunLength = 100.0;
+    numPlanted = 0;
+    numDuplicates = 0;
+    numRandom = 0;
+    expectedMatches = 0;
+    resetGenome();
+}
+
+void WorkloadGenerator::resetGenome()
+{
+    //Genome has own stream so it can be rebuilt without reading file back
+    genomeState = seedValue ^ 0x6A09E667F3BCC908ull;
+    baseBits = 0;
+    numBaseBits = 0;
+    genomePosition = 0;
+    runRemaining = 0;
+    nextRunStart = drawGap();
+}
+
+unsigned long long WorkloadGenerator::drawGap()
+{
+    //Runs start at random, so gaps between them are exponential
+    if(nRunRate <= 0.0)
+    {
+        return ~0ull;
+    }
+    double uniformValue = ((nextRandom(genomeState) >> 11) + 1) * (1.0 / 9007199254740993.0);
+    return genomePosition + (unsigned long long)(-log(uniformValue) * 1000000.0 / nRunRate);
+}
+
+void WorkloadGenerator::fillGenome(char *destBuffer, unsigned long long length)
+{
+    for(unsigned long long index = 0; index < length; index++, genomePosition++)
+    {
+        //Start N run once its position is reached, lengths are exponential around nRunLength
+        if(runRemaining == 0 && genomePosition >= nextRunStart)
+        {
+            double uniformValue = ((nextRandom(genomeState) >> 11) + 1) * (1.0 / 9007199254740993.0);
+            runRemaining = 1 + (unsigned long long)(-log(uniformValue) * (nRunLength - 1.0));
+        }
+        if(runRemaining > 0)
+        {
+            destBuffer[index] = 'N';
+            runRemaining--;
+            if(runRemaining == 0)
+            {
+                nextRunStart = drawGap();
+            }
+            continue;
+        }
+
+        //Otherwise take two bits per ACGT character
+        if(numBaseBits == 0)
+        {
+            baseBits = nextRandom(genomeState);
+            numBaseBits = 64;
+        }
+        destBuffer[index] = "ACGT"[baseBits & 3];
+        baseBits >>= 2;
+        numBaseBits -= 2;
+    }
+}
+
+unsigned long long WorkloadGenerator::chooseTypes(std::vector<unsigned char> *typeArray)
+{
+    //Query types come from own stream so they can be chosen twice without storing them
+    unsigned long long typeState = seedValue ^ 0xBB67AE8584CAA73Bull;
+    unsigned long long plantedCount = 0;
+    for(unsigned long long index = 0; index < numQueries; index++)
+    {
+        double uniformValue = (nextRandom(typeState) >> 11) * (1.0 / 9007199254740992.0);
+        unsigned char queryType = 0;
+        if(index > 0 && uniformValue < duplicateFraction)
+        {
+            queryType = 2;
+        }
+        else if(uniformValue < duplicateFraction + plantedFraction && genomeLength >= QUERY_LENGTH)
+        {
+            queryType = 1;
+            plantedCount++;
+        }
+        if(typeArray != NULL)
+        {
+            typeArray->push_back(queryType);
+        }
+    }
+    return plantedCount;
+}
+
+bool WorkloadGenerator::generate(FILE *genomeFile, FILE *queryFile)
+{
+    //Initialize function/variables
+    KmerEncoder windowEncoder;
+    unsigned long long positionState = seedValue ^ 0x3C6EF372FE94F82Bull;
+    unsigned long long queryState = seedValue ^ 0xA54FF53A5F1D36F1ull;
+    numPlanted = chooseTypes(NULL);
+    numDuplicates = 0;
+    numRandom = 0;
+    expectedMatches = 0;
+
+    //Pick window of genome for each planted query, in genome order so they can be copied in one pass
+    vector<unsigned long long> plantedPositions(numPlanted);
+    for(unsigned long long index = 0; index < numPlanted; index++)
+    {
+        plantedPositions[index] = nextRandom(positionState) % (genomeLength - QUERY_LENGTH + 1);
+    }
+    sort(plantedPositions.begin(), plantedPositions.end());
+
+    //Write genome in lines, keeping last QUERY_LENGTH - 1 characters so windows can cross chunks
+    vector<unsigned long long> plantedKeys(numPlanted);
+    unsigned long long plantedIndex = 0;
+    char *chunkBuffer = new char[STREAM_BLOCK + QUERY_LENGTH];
+    unsigned long long carryLength = 0;
+    unsigned long long chunkStart = 0;
+    resetGenome();
+    fprintf(genomeFile, ">synthetic-%llu\n", seedValue);
+    for(unsigned long long charIndex = 0; charIndex < genomeLength; )
+    {
+        unsigned long long newLength = genomeLength - charIndex;
+        if(newLength > STREAM_BLOCK)
+        {
+            newLength = STREAM_BLOCK;
+        }
+        fillGenome(chunkBuffer + carryLength, newLength);
+        unsigned long long lineStart = 0;
+        while(lineStart < newLength)
+        {
+            //Lines end every FASTA_LINE_LENGTH characters of whole genome, not of chunk
+            unsigned long long lineEnd = charIndex + lineStart + FASTA_LINE_LENGTH
+                                            - (charIndex + lineStart) % FASTA_LINE_LENGTH;
+            unsigned long long lineLength = lineEnd - (charIndex + lineStart);
+            if(lineLength > newLength - lineStart)
+            {
+                lineLength = newLength - lineStart;
+            }
+            fwrite(chunkBuffer + carryLength + lineStart, 1, lineLength, genomeFile);
+            lineStart += lineLength;
+            if(charIndex + lineStart == lineEnd || charIndex + lineStart == genomeLength)
+            {
+                fputc('\n', genomeFile);
+            }
+        }
+        charIndex += newLength;
+
+        //Copy every planted window that ends inside buffer
+        unsigned long long bufferLength = carryLength + newLength;
+        while(plantedIndex < numPlanted && plantedPositions[plantedIndex] + QUERY_LENGTH <= chunkStart + bufferLength)
+        {
+            bool validFlag = true;
+            plantedKeys[plantedIndex] = windowEncoder.encodeWindow(chunkBuffer,
+                                            plantedPositions[plantedIndex] - chunkStart, validFlag);
+            plantedIndex++;
+        }
+
+        //Carry end of buffer to front for next chunk
+        carryLength = (bufferLength < QUERY_LENGTH - 1) ? bufferLength : QUERY_LENGTH - 1;
+        memmove(chunkBuffer, chunkBuffer + bufferLength - carryLength, carryLength);
+        chunkStart += bufferLength - carryLength;
+    }
+
+    //Planted windows were taken in genome order, shuffle them so query order says nothing
+    for(unsigned long long index = numPlanted; index > 1; index--)
+    {
+        swap(plantedKeys[index - 1], plantedKeys[nextRandom(queryState) % index]);
+    }
+
+    //Write queries, keeping every key so duplicates can repeat earlier ones
+    vector<unsigned char> typeArray;
+    typeArray.reserve(numQueries);
+    chooseTypes(&typeArray);
+    vector<unsigned long long> queryKeys(numQueries);
+    plantedIndex = 0;
+    for(unsigned long long index = 0; index < numQueries; index++)
+    {
+        if(typeArray[index] == 2)
+        {
+            queryKeys[index] = queryKeys[nextRandom(queryState) % index];
+            numDuplicates++;
+        }
+        else if(typeArray[index] == 1)
+        {
+            queryKeys[index] = plantedKeys[plantedIndex++];
+        }
+        else
+        {
+            //Random ACGT query, matches only by chance
+            char randomQuery[QUERY_LENGTH];
+            unsigned long long randomBits = nextRandom(queryState);
+            for(unsigned int charIndex = 0; charIndex < QUERY_LENGTH; charIndex++)
+            {
+                randomQuery[charIndex] = "ACGT"[(randomBits >> (2 * charIndex)) & 3];
+            }
+            bool validFlag = true;
+            queryKeys[index] = windowEncoder.encodeWindow(randomQuery, 0, validFlag);
+            numRandom++;
+        }
+        char queryString[QUERY_LENGTH + 1];
+        windowEncoder.decodeKey(queryKeys[index], queryString);
+        fprintf(queryFile, ">query-%llu\n%s\n", index, queryString);
+    }
+    vector<unsigned char>().swap(typeArray);
+    vector<unsigned long long>().swap(plantedKeys);
+    vector<unsigned long long>().swap(plantedPositions);
+
+    //Count genome windows equal to some query by rebuilding genome from its seed
+    removeDuplicateKeys(queryKeys);
+
+    //Keys are below 5^16 < 2^38, bucket them by top bits so each window searches a few keys
+    unsigned int bucketShift = 38;
+    while(bucketShift > 0 && (1ull << (38 - bucketShift)) < queryKeys.size())
+    {
+        bucketShift--;
+    }
+    vector<unsigned long long> bucketStarts((1ull << (38 - bucketShift)) + 1, 0);
+    for(unsigned long long index = 0; index < queryKeys.size(); index++)
+    {
+        bucketStarts[(queryKeys[index] >> bucketShift) + 1]++;
+    }
+    for(unsigned long long index = 1; index < bucketStarts.size(); index++)
+    {
+        bucketStarts[index] += bucketStarts[index - 1];
+    }
+    unsigned char *digitBuffer = new unsigned char[STREAM_BLOCK];
+    KmerEncoder scanEncoder;
+    resetGenome();
+    for(unsigned long long charIndex = 0; charIndex < genomeLength; )
+    {
+        unsigned long long newLength = genomeLength - charIndex;
+        if(newLength > STREAM_BLOCK)
+        {
+            newLength = STREAM_BLOCK;
+        }
+        fillGenome(chunkBuffer, newLength);
+        scanEncoder.encodeBlock(chunkBuffer, digitBuffer, (unsigned int)newLength);
+        for(unsigned long long index = 0; index < newLength; index++)
+        {
+            unsigned long long windowKey = scanEncoder.rollDigit(digitBuffer[index]);
+            if(scanEncoder.windowValid())
+            {
+                unsigned long long bucketIndex = windowKey >> bucketShift;
+                expectedMatches += binary_search(queryKeys.begin() + bucketStarts[bucketIndex],
+                                                    queryKeys.begin() + bucketStarts[bucketIndex + 1], windowKey);
+            }
+        }
+        charIndex += newLength;
+    }
+    delete[] digitBuffer;
+    delete[] chunkBuffer;
+
+    fflush(genomeFile);
+    fflush(queryFile);
+    return !ferror(genomeFile) && !ferror(queryFile);
+}
+
+unsigned long long nextRandom(unsigned long long &randomState)
+{
+    //SplitMix64, small and same on every platform
+    randomState += 0x9E3779B97F4A7C15ull;
+    unsigned long long mixValue = randomState;
+    mixValue = (mixValue ^ (mixValue >> 30)) * 0xBF58476D1CE4E5B9ull;
+    mixValue = (mixValue ^ (mixValue >> 27)) * 0x94D049BB133111EBull;
+    return mixValue ^ (mixValue >> 31);
+}
+
+unsigned int countQueries(FILE *queryFile)
+{
+    //Count every sequence character in query file
+    FastaReader countReader;
+    unsigned long long numLetters = countReader.countFile(queryFile);
+
+    //Return number of full fragments
+    return (unsigned int)(numLetters / QUERY_LENGTH);
+}
+
+void readQueryKeys(FILE *queryFile, KmerEncoder &queryEncoder, vector<unsigned long long> &queryKeys,
+                    unsigned int &numInvalid)
+{
+    //Read every query character into one buffer
+    FastaReader queryReader;
+    queryReader.readQueries(queryFile, QUERY_LENGTH);
+
+    //Encode each full fragment of 16 characters, skip queries outside NATCG
+    queryKeys.reserve(queryKeys.size() + (queryReader.sequenceLength / QUERY_LENGTH));
+    for(unsigned long long index = 0; index + QUERY_LENGTH <= queryReader.sequenceLength;
+                                                                index += QUERY_LENGTH)
+    {
+        bool validFlag = true;
+        unsigned long long queryKey = queryEncoder.canonicalKey(queryEncoder.encodeWindow(queryReader.sequenceBuffer,
+                                                                    index, validFlag));
+        if(validFlag)
+        {
+            queryKeys.push_back(queryKey);
+        }
+        else
+        {
+            numInvalid += 1;
+        }
+    }
+}
+
+template <class KeyType>
+unsigned int removeDuplicateKeys(vector<KeyType> &queryKeys)
+{
+    //Sort and remove duplicate queries, return number removed
+    sort(queryKeys.begin(), queryKeys.end());
+    unsigned int numKeys = (unsigned int)queryKeys.size();
+    queryKeys.erase(unique(queryKeys.begin(), queryKeys.end()), queryKeys.end());
+    return numKeys - (unsigned int)queryKeys.size();
+}
+
+unsigned int collectUniqueKeys(FILE *queryFile, KmerEncoder &queryEncoder, vector<unsigned long long> &queryKeys,
+                    unsigned int &numInvalid)
+{
+    readQueryKeys(queryFile, queryEncoder, queryKeys, numInvalid);
+    return removeDuplicateKeys(queryKeys);
+}
+
+long long elapsedUSecs(const struct timeval &startTime, const struct timeval &endTime)
+{
+    return ((long long)(endTime.tv_sec - startTime.tv_sec) * 1000000) + (endTime.tv_usec - startTime.tv_usec);
+}
+
+void printElapsed(const struct timeval &startTime, const struct timeval &endTime, const char *taskName)
+{
+    long long uSecDiff = elapsedUSecs(startTime, endTime);
+
+    cout << "It took " << (uSecDiff / 1000000) << "." << setw(6) << setfill('0')
+            << (uSecDiff % 1000000) << setfill(' ')
+            << " seconds to " << taskName << endl;
+}
+
+unsigned long long checksumBytes(const void *byteData, unsigned long long numBytes, unsigned long long checksum)
+{
+    //Mix in eight bytes at a time, FNV style multiply on each word
+    const unsigned char *wkgBytes = (const unsigned char *)byteData;
+    unsigned long long byteIndex = 0;
+    for(; byteIndex + 8 <= numBytes; byteIndex += 8)
+    {
+        unsigned long long wkgWord;
+        memcpy(&wkgWord, wkgBytes + byteIndex, 8);
+        checksum = (checksum ^ wkgWord) * 0x100000001B3ull;
+        checksum ^= checksum >> 29;
+    }
+
+    //Mix in any remaining bytes one at a time
+    for(; byteIndex < numBytes; byteIndex++)
+    {
+        checksum = (checksum ^ wkgBytes[byteIndex]) * 0x100000001B3ull;
+    }
+    return checksum;
+}
+
+unsigned long long chainTableBytes(unsigned int numItems, double loadFactor)
+{
+    //List heads plus whole slabs of nodes, duplicates counted as distinct
+    unsigned long long numSlabs = ((unsigned long long)numItems + SLAB_NODES - 1) / SLAB_NODES;
+    return ((unsigned long long)findTableSize(numItems, loadFactor) * sizeof(HashLL))
+            + (numSlabs * SLAB_NODES * sizeof(LLNode));
+}
+
+unsigned int findTableSize(unsigned int numItems, double loadFactor)
+{
+    //Initialize function/variables
+    unsigned int tableSize = 2;
+
+    //Double size until items fit under load factor
+    while(numItems > loadFactor * tableSize && tableSize < 0x80000000u)
+    {
+        tableSize *= 2;
+    }
+
+    //Return power of two table size
+    return tableSize;
+}
+
+template <class QueryTable>
+void searchBatch(QueryTable *queryTable, const unsigned long long *batchKeys, unsigned int numKeys,
+                    bool *batchResults)
+{
+    //First pass starts every load so cache misses overlap
+    for(unsigned int index = 0; index < numKeys; index++)
+    {
+        queryTable->prefetchKey(batchKeys[index]);
+    }
+
+    //Second pass finds loads already in flight or done
+    for(unsigned int index = 0; index < numKeys; index++)
+    {
+        batchResults[index] = queryTable->searchKey(batchKeys[index]);
+    }
+}
+
+void searchBatch(Queries_HT *queryTable, const unsigned long long *batchKeys, unsigned int numKeys,
+                    bool *batchResults)
+{
+    //Chained lookups need several dependent hops, so interleave whole lookups
+    //rather than prefetching list heads only
+    queryTable->searchInterleaved(batchKeys, numKeys, batchResults);
+}
+
+template <class QueryTable, bool CanonicalMode>
+void scanRange(QueryTable *queryTable, const char *genomeString, unsigned long long startIndex,
+                    unsigned long long endIndex, unsigned int batchSize, ScanResult *scanResult)
+{
+    //Initialize rolling encoder for genome windows
+    KmerEncoder windowEncoder;
+    unsigned long long windowKey = 0;
+    unsigned char digitBuffer[SCAN_BLOCK];
+
+    //Windows waiting for batched lookup, with their forward keys and positions
+    unsigned long long batchKeys[MAX_BATCH];
+    unsigned long long batchWindows[MAX_BATCH];
+    unsigned long long batchPositions[MAX_BATCH];
+    bool batchResults[MAX_BATCH];
+    unsigned int batchCount = 0;
+
+    //Count this thread only, each scan thread reports its own counters
+    if(PerfCounters::countingFlag)
+    {
+        scanResult->rangeCounters.startCounters(false);
+    }
+
+    //Every character from first window start to end of last window
+    unsigned long long charIndex = startIndex;
+    unsigned long long charEnd = endIndex + QUERY_LENGTH - 1;
+    scanResult->numWindows += endIndex - startIndex;
+
+    //Loop over genome in blocks, converting each block to digits at once
+    while(charIndex < charEnd)
+    {
+        unsigned int blockLength = SCAN_BLOCK;
+        if(charEnd - charIndex < SCAN_BLOCK)
+        {
+            blockLength = (unsigned int)(charEnd - charIndex);
+        }
+        windowEncoder.encodeBlock(genomeString + charIndex, digitBuffer, blockLength);
+
+        //Slide window one digit at a time
+        for(unsigned int blockIndex = 0; blockIndex < blockLength; blockIndex++, charIndex++)
+        {
+            //Canonical mode also rolls reverse complement and looks up smaller key
+            //Choice is made at compile time so forward scans pay nothing for it
+            unsigned long long lookupKey;
+            if(CanonicalMode)
+            {
+                lookupKey = windowEncoder.rollCanonical(digitBuffer[blockIndex]);
+                windowKey = windowEncoder.windowKey;
+            }
+            else
+            {
+                windowKey = windowEncoder.rollDigit(digitBuffer[blockIndex]);
+                lookupKey = windowKey;
+            }
+
+            //Only windows holding 16 NATCG characters can match
+            bool probeFlag = windowEncoder.windowValid();
+
+            //Let prefilter reject window before table is probed
+            if(probeFlag && queryTable->prefilter != NULL)
+            {
+                probeFlag = queryTable->prefilter->mayContain(lookupKey);
+                scanResult->prefilterPasses += probeFlag;
+                scanResult->prefilterRejects += !probeFlag;
+            }
+
+            //Queue window for batched lookup, window ends at current character
+            if(probeFlag && batchSize > 1)
+            {
+                batchKeys[batchCount] = lookupKey;
+                batchWindows[batchCount] = windowKey;
+                batchPositions[batchCount] = charIndex + 1 - QUERY_LENGTH;
+                batchCount++;
+                probeFlag = false;
+            }
+
+            //Check for successful search, one window at a time when batching is off
+            if(probeFlag && queryTable->searchKey(lookupKey))
+            {
+                scanResult->addMatch(charIndex + 1 - QUERY_LENGTH, windowKey);
+            }
+
+            //Resolve queued windows once batch is full or range is done
+            if(batchCount == batchSize || (batchCount > 0 && charIndex + 1 == charEnd))
+            {
+                searchBatch(queryTable, batchKeys, batchCount, batchResults);
+                for(unsigned int batchIndex = 0; batchIndex < batchCount; batchIndex++)
+                {
+                    if(batchResults[batchIndex])
+                    {
+                        scanResult->addMatch(batchPositions[batchIndex], batchWindows[batchIndex]);
+                    }
+                }
+                batchCount = 0;
+            }
+        }
+    }
+
+    if(PerfCounters::countingFlag)
+    {
+        scanResult->rangeCounters.stopCounters();
+    }
+}
+
+template <class QueryTable>
+ScanResult searchGenome(QueryTable &queryTable, const char *genomeString, unsigned long long numSubstrings,
+                    unsigned int numThreads, unsigned int batchSize)
+{
+    //Initialize function/variables
+    ScanResult totalResult;
+
+    //Never use more threads than windows
+    if(numThreads > numSubstrings)
+    {
+        numThreads = (unsigned int)numSubstrings;
+    }
+
+    //Pick forward or canonical scan once for whole genome
+    void (*rangeFunction)(QueryTable *, const char *, unsigned long long, unsigned long long,
+                            unsigned int, ScanResult *) = scanRange<QueryTable, false>;
+    if(queryTable.queryEncoder.canonicalFlag)
+    {
+        rangeFunction = scanRange<QueryTable, true>;
+    }
+
+    //Scan on calling thread when only one thread requested
+    if(numThreads <= 1)
+    {
+        rangeFunction(&queryTable, genomeString, 0, numSubstrings, batchSize, &totalResult);
+        if(PerfCounters::countingFlag)
+        {
+            totalResult.threadCounters.push_back(totalResult.rangeCounters);
+        }
+        return totalResult;
+    }
+
+    //Give each thread an equal range of window start positions
+    //Each range reads QUERY_LENGTH - 1 characters past its last start,
+    //so neighbouring ranges overlap and every window is scanned once
+    vector<ScanResult> threadResults(numThreads);
+    vector<thread> scanThreads;
+    unsigned long long rangeSize = numSubstrings / numThreads;
+    unsigned long long startIndex = 0;
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        unsigned long long endIndex = startIndex + rangeSize + (threadIndex < numSubstrings % numThreads);
+        scanThreads.push_back(thread(rangeFunction, &queryTable, genomeString,
+                                        startIndex, endIndex, batchSize, &threadResults[threadIndex]));
+        startIndex = endIndex;
+    }
+
+    //Wait for every thread, then merge results in genome order
+    for(unsigned int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+    {
+        scanThreads[threadIndex].join();
+        totalResult.mergeResult(threadResults[threadIndex]);
+        if(PerfCounters::countingFlag)
+        {
+            totalResult.threadCounters.push_back(threadResults[threadIndex].rangeCounters);
+        }
+    }
+    return totalResult;
+}
+
+template <class QueryTable>
+ScanResult streamGenome(QueryTable &queryTable, FILE *genomeFile, FastaReader &genomeReader,
+                    unsigned long long chunkLength, unsigned int numThreads, unsigned int batchSize,
+                    MatchReport *matchReport)
+{
+    //Initialize function/variables
+    ScanResult totalResult;
+    unsigned long long carryLength = 0;
+    unsigned long long chunkStart = 0;
+    bool moreFlag = true;
+
+    //Buffer holds one chunk plus characters carried from end of last chunk
+    char *chunkBuffer = new char[chunkLength + QUERY_LENGTH];
+
+    //Read and scan one chunk at a time, memory use depends on number of records but not on
+    //genome size or, when matches are reported, on number of matches
+    while(moreFlag)
+    {
+        unsigned long long newLength = genomeReader.readChunk(genomeFile, chunkBuffer + carryLength, chunkLength);
+        unsigned long long bufferLength = carryLength + newLength;
+        moreFlag = (newLength == chunkLength);
+
+        //Sequence before first header gets its record now, so matches can be named chunk by chunk
+        if(newLength > 0)
+        {
+            genomeReader.finishRecords();
+        }
+
+        //Scan every window starting in buffer, last window ends at end of buffer
+        if(bufferLength >= QUERY_LENGTH)
+        {
+            ScanResult chunkResult = searchGenome(queryTable, chunkBuffer, bufferLength - QUERY_LENGTH + 1,
+                                                            numThreads, batchSize);
+
+            //Move positions from chunk to genome
+            for(unsigned long long index = 0; index < chunkResult.matchPositions.size(); index++)
+            {
+                chunkResult.matchPositions[index] += chunkStart;
+            }
+
+            //Write matches of chunk, then keep only those still needed for printing
+            if(matchReport != NULL)
+            {
+                matchReport->writeMatches(chunkResult, genomeReader);
+                chunkResult.trimMatches((totalResult.matchPositions.size() < MAX_PRINTED_MATCHES)
+                                            ? MAX_PRINTED_MATCHES - totalResult.matchPositions.size() : 0);
+            }
+            totalResult.mergeResult(chunkResult);
+        }
+
+        //Carry last QUERY_LENGTH - 1 characters so windows spanning chunks are scanned once
+        carryLength = min(bufferLength, (unsigned long long)(QUERY_LENGTH - 1));
+        memmove(chunkBuffer, chunkBuffer + bufferLength - carryLength, carryLength);
+        chunkStart += bufferLength - carryLength;
+    }
+
+    //Deallocate chunk buffer
+    delete[] chunkBuffer;
+    genomeReader.finishRecords();
+    return totalResult;
+}
+
+unsigned int packBase(char baseChar)
+{
+    //Check provided character and return two bit value
+    switch(baseChar)
+    {
+        case 'A':
+            return 0u;
+        case 'C':
+            return 1u;
+        case 'G':
+            return 2u;
+        case 'T':
+            return 3u;
+    }
+    return INVALID_PACKED;
+}
+
+template <unsigned int KmerLength>
+KmerTable<KmerLength>::KmerTable()
+{
+    //Set all values to defaults
+    numQueries = 0;
+    numInvalid = 0;
+    keyArray = NULL;
+}
+
+template <unsigned int KmerLength>
+KmerTable<KmerLength>::~KmerTable()
+{
+    //Deallocate key array
+    free(keyArray);
+}
+
+template <unsigned int KmerLength>
+bool KmerTable<KmerLength>::encodeKmer(const char *sequence, KeyType &kmerKey)
+{
+    //Initialize variables
+    KeyType wkgKey = 0;
+    unsigned int invalidBits = 0;
+
+    //Trip count is known at compile time so loop is fully unrolled
+    #pragma GCC unroll 32
+    for(unsigned int index = 0; index < KmerLength; index++)
+    {
+        unsigned int baseCode = packBase(sequence[index]);
+        invalidBits |= baseCode;
+        wkgKey = (wkgKey << 2) | (baseCode & 3u);
+    }
+
+    //Any invalid base sets bit above two bit codes
+    kmerKey = wkgKey;
+    return (invalidBits & INVALID_PACKED) == 0;
+}
+
+template <unsigned int KmerLength>
+unsigned int KmerTable<KmerLength>::fillKeys(FILE *queryFile)
+{
+    //Read every query character into one buffer
+    FastaReader queryReader;
+    vector<KeyType> sortedKeys;
+    queryReader.readQueries(queryFile, KmerLength);
+
+    //Pack each full fragment, skip queries outside ACGT
+    sortedKeys.reserve(queryReader.sequenceLength / KmerLength);
+    for(unsigned long long index = 0; index + KmerLength <= queryReader.sequenceLength;
+                                                                index += KmerLength)
+    {
+        KeyType queryKey;
+        if(encodeKmer(queryReader.sequenceBuffer + index, queryKey))
+        {
+            sortedKeys.push_back(queryKey);
+        }
+        else
+        {
+            numInvalid += 1;
+        }
+    }
+
+    //Sort and remove duplicate queries
+    unsigned int numDuplicates = removeDuplicateKeys(sortedKeys);
+    numQueries = (unsigned int)sortedKeys.size();
+
+    //Allocate array aligned so keys of one group of descendants share a cache line
+    void *keyMemory = NULL;
+    free(keyArray);
+    keyArray = NULL;
+    if(posix_memalign(&keyMemory, 64, ((size_t)numQueries + 1) * sizeof(KeyType)) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    keyArray = (KeyType *)keyMemory;
+    keyArray[0] = 0;
+
+    //Lay out keys for branchless descent
+    layoutKeys(sortedKeys.data(), 0, 1);
+    return numDuplicates;
+}
+
+template <unsigned int KmerLength>
+unsigned int KmerTable<KmerLength>::layoutKeys(const KeyType *sortedKeys, unsigned int sortedIndex,
+                                                    unsigned int arrayIndex)
+{
+    //In-order walk of implicit tree hands out sorted keys smallest first
+    if(arrayIndex <= numQueries)
+    {
+        sortedIndex = layoutKeys(sortedKeys, sortedIndex, 2 * arrayIndex);
+        keyArray[arrayIndex] = sortedKeys[sortedIndex];
+        sortedIndex++;
+        sortedIndex = layoutKeys(sortedKeys, sortedIndex, (2 * arrayIndex) + 1);
+    }
+
+    //Return next sorted key to hand out
+    return sortedIndex;
+}
+
+template <unsigned int KmerLength>
+bool KmerTable<KmerLength>::searchKey(KeyType kmerKey)
+{
+    //Descend from root, same branchless walk as sorted query array
+    const KeyType *keyData = keyArray;
+    unsigned long long wkgIndex = 1;
+    while(wkgIndex <= numQueries)
+    {
+        __builtin_prefetch(keyData + (wkgIndex * (64 / sizeof(KeyType))));
+        wkgIndex = (2 * wkgIndex) + (keyData[wkgIndex] < kmerKey);
+    }
+    wkgIndex >>= __builtin_ffsll(~wkgIndex);
+    return (wkgIndex != 0) && (keyData[wkgIndex] == kmerKey);
+}
+
+template <unsigned int KmerLength>
+ScanResult KmerTable<KmerLength>::scanGenome(const char *genomeString, unsigned long long genomeLength)
+{
+    //Initialize rolling key and count of characters since last bad base
+    ScanResult scanResult;
+    KeyType windowKey = 0;
+    unsigned int validRun = 0;
+
+    //Slide window one base at a time
+    scanResult.numWindows = (genomeLength >= KmerLength) ? genomeLength - KmerLength + 1 : 0;
+    for(unsigned long long charIndex = 0; charIndex < genomeLength; charIndex++)
+    {
+        unsigned int baseCode = packBase(genomeString[charIndex]);
+        windowKey = ((windowKey << 2) | (baseCode & 3u)) & KEY_MASK;
+        validRun = (baseCode == INVALID_PACKED) ? 0 : validRun + 1;
+
+        //Check for successful search once window holds k good bases
+        if(validRun >= KmerLength && searchKey(windowKey))
+        {
+            scanResult.addMatch(charIndex + 1 - KmerLength, windowKey);
+        }
+    }
+    return scanResult;
+}
+
+template <unsigned int KmerLength>
+ScanResult runKmerSearch(FILE *queryFile, const char *genomeString,
+                    unsigned long long genomeLength, bool timerFlag, bool searchTimerFlag)
+{
+    //Initialize variables
+    struct timeval fillStartTime, fillEndTime;
+    KmerTable<KmerLength> kmerTable;
+
+    cout << "Creating and filling " << KmerLength << "-mer query array with "
+            << (8 * sizeof(typename KmerTable<KmerLength>::KeyType)) << "-bit keys" << endl;
+
+    //Check for timer start
+    if(timerFlag)
+    {
+        gettimeofday( &fillStartTime, NULL);
+    }
+
+    unsigned int numDuplicates = kmerTable.fillKeys(queryFile);
+
+    //Check for timer end
+    if(timerFlag)
+    {
+        gettimeofday( &fillEndTime, NULL);
+
+        printElapsed(fillStartTime, fillEndTime, "fill the query array");
+    }
+    cout << numDuplicates << " duplicate queries were removed leaving " << kmerTable.numQueries << endl;
+    cout << kmerTable.numInvalid << " queries skipped for bases outside ACGT" << endl;
+
+    //Scan genome with table for this length
+    struct timeval searchStartTime, searchEndTime;
+    gettimeofday( &searchStartTime, NULL);
+    ScanResult scanResult = kmerTable.scanGenome(genomeString, genomeLength);
+    gettimeofday( &searchEndTime, NULL);
+
+    //Print search time
+    if(searchTimerFlag)
+    {
+        printElapsed(searchStartTime, searchEndTime, "search the query array");
+    }
+    return scanResult;
+}
+
+bool dispatchKmerSearch(unsigned int kmerLength, FILE *queryFile, const char *genomeString,
+                    unsigned long long genomeLength, bool timerFlag, bool searchTimerFlag,
+                    ScanResult &scanResult)
+{
+    //Pick instantiation for requested length, only common read lengths are built
+    switch(kmerLength)
+    {
+        case 16:
+            scanResult = runKmerSearch<16>(queryFile, genomeString, genomeLength, timerFlag, searchTimerFlag);
+            return true;
+        case 21:
+            scanResult = runKmerSearch<21>(queryFile, genomeString, genomeLength, timerFlag, searchTimerFlag);
+            return true;
+        case 25:
+            scanResult = runKmerSearch<25>(queryFile, genomeString, genomeLength, timerFlag, searchTimerFlag);
+            return true;
+        case 31:
+            scanResult = runKmerSearch<31>(queryFile, genomeString, genomeLength, timerFlag, searchTimerFlag);
+            return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    //Initialize variables
+    FILE *genomeFile = fopen(argv[1], "r");
+    FILE *queryFile = fopen(argv[2], "r");
+    bool collisionTimerFlag = false;
+    bool searchTimerFlag = false;
+    unsigned int backendType = BACKEND_CHAIN;
+    bool autoFlag = true;
+    double maxLoadFactor = DEFAULT_LOAD_FACTOR;
+    bool loadFactorFlag = false;
+    unsigned int numThreads = 1;
+    unsigned int batchSize = DEFAULT_BATCH;
+    double prefilterRate = 0.0;
+    unsigned int kmerLength = 0;
+    const char *indexPath = NULL;
+    const char *writePath = NULL;
+    bool verifyFlag = true;
+    unsigned long long streamLength = 0;
+    const char *reportPath = NULL;
+    bool canonicalFlag = false;
+    bool statsFlag = false;
+    const char *statsPath = NULL;
+    PerfCounters buildCounters, loadCounters, searchCounters;
+
+    char *genomeString = NULL;
+
+    int argIndex = 3;
+
+    unsigned int numCollisions = 0;
+
+    struct timeval searchStartTime, searchEndTime;
+
+    unsigned long long numMatches = 0;
+
+    while (argIndex < argc)
+    {
+        if(compareString(argv[argIndex], "-c") == 0)
+        {
+            collisionTimerFlag = true;
+        }
+        else if(compareString(argv[argIndex], "-s") == 0)
+        {
+            searchTimerFlag = true;
+        }
+        else if(compareString(argv[argIndex], "-b") == 0 && argIndex + 1 < argc)
+        {
+            //Select query table backend, chained table by default
+            argIndex += 1;
+            if(compareString(argv[argIndex], "flat") == 0)
+            {
+                backendType = BACKEND_FLAT;
+            }
+            else if(compareString(argv[argIndex], "sorted") == 0)
+            {
+                backendType = BACKEND_SORTED;
+            }
+            else if(compareString(argv[argIndex], "approx") == 0)
+            {
+                backendType = BACKEND_APPROX;
+            }
+            else if(compareString(argv[argIndex], "perfect") == 0)
+            {
+                backendType = BACKEND_PERFECT;
+            }
+            else if(compareString(argv[argIndex], "bitmap") == 0)
+            {
+                backendType = BACKEND_BITMAP;
+            }
+            autoFlag = false;
+        }
+        else if(compareString(argv[argIndex], "-l") == 0 && argIndex + 1 < argc)
+        {
+            //Set largest ratio of queries to table size
+            argIndex += 1;
+            loadFactorFlag = true;
+            maxLoadFactor = atof(argv[argIndex]);
+            if(maxLoadFactor <= 0.0 || maxLoadFactor >= 1.0)
+            {
+                maxLoadFactor = DEFAULT_LOAD_FACTOR;
+            }
+        }
+        else if(compareString(argv[argIndex], "-p") == 0 && argIndex + 1 < argc)
+        {
+            //Turn on prefilter with requested false positive rate
+            argIndex += 1;
+            prefilterRate = atof(argv[argIndex]);
+            if(prefilterRate <= 0.0 || prefilterRate >= 1.0)
+            {
+                prefilterRate = 0.0;
+            }
+        }
+        else if(compareString(argv[argIndex], "-t") == 0 && argIndex + 1 < argc)
+        {
+            //Set number of scan threads, zero uses every hardware thread
+            argIndex += 1;
+            numThreads = (unsigned int)atoi(argv[argIndex]);
+            if(numThreads == 0)
+            {
+                numThreads = thread::hardware_concurrency();
+            }
+            if(numThreads == 0)
+            {
+                numThreads = 1;
+            }
+        }
+        else if(compareString(argv[argIndex], "-B") == 0 && argIndex + 1 < argc)
+        {
+            //Set number of windows looked up together, one turns batching off
+            argIndex += 1;
+            batchSize = (unsigned int)atoi(argv[argIndex]);
+            if(batchSize == 0)
+            {
+                batchSize = 1;
+            }
+            if(batchSize > MAX_BATCH)
+            {
+                batchSize = MAX_BATCH;
+            }
+        }
+        else if(compareString(argv[argIndex], "-k") == 0 && argIndex + 1 < argc)
+        {
+            //Use packed k-mer engine for requested query length
+            argIndex += 1;
+            kmerLength = (unsigned int)atoi(argv[argIndex]);
+        }
+        else if(compareString(argv[argIndex], "-i") == 0 && argIndex + 1 < argc)
+        {
+            //Load chained table from index file instead of query file
+            argIndex += 1;
+            indexPath = argv[argIndex];
+        }
+        else if(compareString(argv[argIndex], "-w") == 0 && argIndex + 1 < argc)
+        {
+            //Save chained table to index file after it is built
+            argIndex += 1;
+            writePath = argv[argIndex];
+        }
+        else if(compareString(argv[argIndex], "-m") == 0 && argIndex + 1 < argc)
+        {
+            //Stream genome in chunks of given number of megabytes instead of loading it whole
+            argIndex += 1;
+            streamLength = strtoull(argv[argIndex], NULL, 10) << 20;
+        }
+        else if(compareString(argv[argIndex], "-o") == 0 && argIndex + 1 < argc)
+        {
+            //Write every match with its genome record, offset and query
+            argIndex += 1;
+            reportPath = argv[argIndex];
+        }
+        else if(compareString(argv[argIndex], "-r") == 0)
+        {
+            //Search reverse complement strand in same pass
+            canonicalFlag = true;
+        }
+        else if(compareString(argv[argIndex], "-H") == 0)
+        {
+            //Back hash array, slot array and genome buffer with 2 MB pages when possible
+            PagePolicy::pageMode = PAGES_HUGE;
+        }
+        else if(compareString(argv[argIndex], "-N") == 0)
+        {
+            //Spread pages of same buffers over every NUMA node
+            PagePolicy::interleaveFlag = true;
+        }
+        else if(compareString(argv[argIndex], "-P") == 0)
+        {
+            //Count cycles, instructions and misses of each phase and scan thread
+            PerfCounters::countingFlag = true;
+        }
+        else if(compareString(argv[argIndex], "-x") == 0)
+        {
+            //Print list lengths, occupancy and lookup counts of chained table
+            statsFlag = true;
+        }
+        else if(compareString(argv[argIndex], "-j") == 0 && argIndex + 1 < argc)
+        {
+            //Write same stats as JSON
+            argIndex += 1;
+            statsPath = argv[argIndex];
+        }
+        else if(compareString(argv[argIndex], "-u") == 0)
+        {
+            //Trust index file without reading every page for its checksum
+            verifyFlag = false;
+        }
+        argIndex += 1;
+    }
+
+    //Every match is only kept when it is reported
+    ScanResult::keepAllFlag = (reportPath != NULL);
+
+    //Near matches are forward strand only and exact prefilter would reject them
+    if(backendType == BACKEND_APPROX && (canonicalFlag || prefilterRate > 0.0))
+    {
+        cout << "Options -r and -p are not supported with -b approx" << endl;
+        return 1;
+    }
+
+    //Bitmap answers exactly from one bit per query, so there is no prefilter to put in front of it
+    if(backendType == BACKEND_BITMAP && prefilterRate > 0.0)
+    {
+        cout << "Option -p is not supported with -b bitmap" << endl;
+        return 1;
+    }
+
+    //Loaded index is always a chained table whose size was fixed when it was saved
+    if(indexPath != NULL && (!autoFlag || loadFactorFlag || writePath != NULL))
+    {
+        cout << "Options -b, -l and -w are not supported with -i" << endl;
+        return 1;
+    }
+
+    //Index file holds radix values only, query file is needed to name matched queries
+    if(indexPath != NULL && reportPath != NULL && queryFile == NULL)
+    {
+        cout << "Option -o with -i needs the query file to name matched queries" << endl;
+        return 1;
+    }
+
+    //Packed k-mer engine for lengths other than base-5 16-mers
+    if(genomeFile != NULL && queryFile != NULL && kmerLength != 0)
+    {
+        //Engine scans whole genome on one thread, one window at a time, forward strand only
+        if(numThreads != 1 || batchSize != DEFAULT_BATCH || streamLength != 0 || reportPath != NULL
+                || canonicalFlag || prefilterRate > 0.0 || !autoFlag || indexPath != NULL || writePath != NULL
+                || statsFlag || statsPath != NULL || PerfCounters::countingFlag)
+        {
+            cout << "Options -t, -B, -m, -o, -r, -p, -b, -i, -w, -x, -j and -P are not supported with -k" << endl;
+            return 1;
+        }
+
+        cout << "Reading Genome File" << endl;
+        FastaReader genomeReader;
+        genomeReader.readFile(genomeFile);
+        genomeString = genomeReader.sequenceBuffer;
+
+        ScanResult scanResult;
+        if(!dispatchKmerSearch(kmerLength, queryFile, genomeString, genomeReader.sequenceLength,
+                                    collisionTimerFlag, searchTimerFlag, scanResult))
+        {
+            cout << "Query length " << kmerLength << " is not supported, use 16, 21, 25 or 31" << endl;
+            return 1;
+        }
+
+        //Print first matching fragments
+        numMatches = scanResult.numMatches;
+        for(unsigned int matchIndex = 0; matchIndex < numMatches && matchIndex < MAX_PRINTED_MATCHES; matchIndex++)
+        {
+            char tempPrint[MAX_KMER_LENGTH + 1];
+            memcpy(tempPrint, genomeString + scanResult.matchPositions[matchIndex], kmerLength);
+            tempPrint[kmerLength] = '\0';
+            cout << "Fragment " << (matchIndex + 1) << " " << tempPrint << endl;
+        }
+        cout << numMatches << " matches found" << endl;
+    }
+
+    //PART ONE
+
+    else if(genomeFile != NULL && (queryFile != NULL || indexPath != NULL))
+    {
+
+    //Populate each table with query dataset
+    //Count number of collisions and time to populate each table
+        Queries_HT *chainTable = NULL;
+        Queries_FlatHT *flatTable = NULL;
+        Queries_Sorted *sortedArray = NULL;
+        Queries_Approx *approxTable = NULL;
+        Queries_Perfect *perfectTable = NULL;
+        Queries_Bitmap *bitmapTable = NULL;
+        unsigned long long tableBytes = 0;
+
+        //Build phase covers counting queries and every build thread
+        if(PerfCounters::countingFlag)
+        {
+            buildCounters.startCounters(true);
+        }
+
+        //Size table from number of queries and load factor
+        //Index files hold a built chained table and need no query file
+        unsigned int tableSize = 0;
+        if(indexPath == NULL)
+        {
+            unsigned int queryCount = countQueries(queryFile);
+            tableSize = findTableSize(queryCount, maxLoadFactor);
+
+            //Bitmap costs same at any query count, so it wins once chained table would be larger
+            //Saved indexes, table stats and prefilter need chained table, so those keep it
+            if(autoFlag && writePath == NULL && !statsFlag && statsPath == NULL && prefilterRate == 0.0
+                    && chainTableBytes(queryCount, maxLoadFactor) > BITMAP_BYTES)
+            {
+                cout << queryCount << " queries need about " << chainTableBytes(queryCount, maxLoadFactor)
+                        << " bytes as chained table, using direct-address bitmap" << endl;
+                backendType = BACKEND_BITMAP;
+            }
+        }
+
+        if(indexPath != NULL)
+        {
+            cout << "Loading hash table from " << indexPath << endl;
+            struct timeval loadStartTime, loadEndTime;
+
+            //Check for timer start
+            if(collisionTimerFlag)
+            {
+                gettimeofday( &loadStartTime, NULL);
+            }
+            chainTable = new Queries_HT();
+            chainTable->prefilterRate = prefilterRate;
+            if(!chainTable->loadIndex(indexPath, verifyFlag))
+            {
+                cout << "Index file missing, damaged or written by another version" << endl;
+                delete chainTable;
+                return 1;
+            }
+
+            //Strand mode is saved with index, so -r cannot add reverse complements afterwards
+            if(canonicalFlag && !chainTable->queryEncoder.canonicalFlag)
+            {
+                cout << "Index file was saved without -r, save it again with -r to search both strands" << endl;
+                delete chainTable;
+                return 1;
+            }
+            if(!canonicalFlag && chainTable->queryEncoder.canonicalFlag)
+            {
+                cout << "Index file was saved with -r, searching both strands" << endl;
+                canonicalFlag = true;
+            }
+
+            //Check for timer end
+            if(collisionTimerFlag)
+            {
+                gettimeofday( &loadEndTime, NULL);
+
+                printElapsed(loadStartTime, loadEndTime, "load the hash table");
+            }
+            tableSize = chainTable->hashTableSize;
+            tableBytes = chainTable->memoryUsage();
+        }
+        else if(backendType == BACKEND_APPROX)
+        {
+            //Near matches are forward strand only
+            cout << "Creating and filling approximate query index" << endl;
+            approxTable = new Queries_Approx(queryFile);
+            numCollisions = approxTable->fillHashes(collisionTimerFlag);
+            tableSize = approxTable->numQueries;
+            tableBytes = approxTable->memoryUsage();
+        }
+        else if(backendType == BACKEND_BITMAP)
+        {
+            cout << "Creating and filling direct-address bitmap" << endl;
+            bitmapTable = new Queries_Bitmap(queryFile);
+            bitmapTable->queryEncoder.canonicalFlag = canonicalFlag;
+            numCollisions = bitmapTable->fillHashes(collisionTimerFlag);
+            tableSize = bitmapTable->numQueries;
+            tableBytes = bitmapTable->memoryUsage();
+            cout << bitmapTable->nKeys.size() << " queries holding N kept outside bitmap" << endl;
+        }
+        else if(backendType == BACKEND_PERFECT)
+        {
+            cout << "Creating and filling perfect hash index" << endl;
+            perfectTable = new Queries_Perfect(queryFile);
+            perfectTable->prefilterRate = prefilterRate;
+            perfectTable->queryEncoder.canonicalFlag = canonicalFlag;
+            numCollisions = perfectTable->fillHashes(collisionTimerFlag);
+            tableSize = perfectTable->numQueries;
+            tableBytes = perfectTable->memoryUsage();
+            cout << setprecision(4) << perfectTable->hashBitsPerKey() << " bits per key for perfect hash, "
+                    << (tableBytes * 8.0 / ((tableSize > 0) ? tableSize : 1)) << " with keys, "
+                    << perfectTable->fallbackKeys.size() << " queries without a pilot" << setprecision(6) << endl;
+        }
+        else if(backendType == BACKEND_SORTED)
+        {
+            cout << "Creating and filling sorted query array" << endl;
+            sortedArray = new Queries_Sorted(queryFile);
+            sortedArray->prefilterRate = prefilterRate;
+            sortedArray->queryEncoder.canonicalFlag = canonicalFlag;
+            numCollisions = sortedArray->fillHashes(collisionTimerFlag);
+            tableSize = sortedArray->numQueries;
+            tableBytes = sortedArray->memoryUsage();
+        }
+        else if(backendType == BACKEND_FLAT)
+        {
+            cout << "Creating and filling flat hash table with size " << tableSize << endl;
+            flatTable = new Queries_FlatHT(queryFile, tableSize, maxLoadFactor);
+            flatTable->prefilterRate = prefilterRate;
+            flatTable->queryEncoder.canonicalFlag = canonicalFlag;
+            numCollisions = flatTable->fillHashes(collisionTimerFlag);
+            tableSize = flatTable->hashTableSize;
+            tableBytes = flatTable->memoryUsage();
+        }
+        else
+        {
+            cout << "Creating and filling hash table with size " << tableSize << endl;
+            chainTable = new Queries_HT(queryFile, tableSize, maxLoadFactor);
+            chainTable->prefilterRate = prefilterRate;
+            chainTable->queryEncoder.canonicalFlag = canonicalFlag;
+            numCollisions = chainTable->fillHashes(collisionTimerFlag, numThreads);
+            tableSize = chainTable->hashTableSize;
+            tableBytes = chainTable->memoryUsage();
+
+            //Save built table for later runs
+            if(writePath != NULL)
+            {
+                if(chainTable->writeIndex(writePath))
+                {
+                    cout << "Hash table saved to " << writePath << endl;
+                }
+                else
+                {
+                    cout << "Could not write index file " << writePath << endl;
+                }
+            }
+        }
+        if(PerfCounters::countingFlag)
+        {
+            buildCounters.stopCounters();
+        }
+
+        if(indexPath != NULL)
+        {
+            cout << chainTable->numQueries << " queries loaded into a table of " << tableSize << endl;
+        }
+        else if(backendType == BACKEND_SORTED || backendType == BACKEND_APPROX || backendType == BACKEND_PERFECT
+                    || backendType == BACKEND_BITMAP)
+        {
+            cout << numCollisions << " duplicate queries were removed leaving " << tableSize << endl;
+        }
+        else
+        {
+            cout << numCollisions << " collisions were found populating a table of " << tableSize << endl;
+        }
+        cout << tableBytes << " bytes used by hash table" << endl;
+
+    //PART TWO
+
+    //Open report before search, streamed chunks are written as they are scanned
+        MatchReport matchReport;
+        MatchReport *chunkReport = NULL;
+        if(reportPath != NULL)
+        {
+            matchReport.approxTable = approxTable;
+            matchReport.reportEncoder.canonicalFlag = canonicalFlag;
+            if(matchReport.openReport(reportPath, queryFile) && streamLength != 0)
+            {
+                chunkReport = &matchReport;
+            }
+        }
+
+    //Read in genome, or stream it in chunks when requested
+        ScanResult scanResult;
+        FastaReader genomeReader;
+        if(streamLength != 0)
+        {
+            cout << "Streaming Genome File in chunks of " << (streamLength >> 20) << " MB" << endl;
+
+            //Check for start timer
+            if(searchTimerFlag)
+            {
+                gettimeofday( &searchStartTime, NULL);
+            }
+            if(PerfCounters::countingFlag)
+            {
+                searchCounters.startCounters(true);
+            }
+
+            //Search each chunk using selected query table as it is read
+            if(approxTable != NULL)
+            {
+                scanResult = streamGenome(*approxTable, genomeFile, genomeReader, streamLength, numThreads, batchSize,
+                                            chunkReport);
+            }
+            else if(bitmapTable != NULL)
+            {
+                scanResult = streamGenome(*bitmapTable, genomeFile, genomeReader, streamLength, numThreads, batchSize,
+                                            chunkReport);
+            }
+            else if(perfectTable != NULL)
+            {
+                scanResult = streamGenome(*perfectTable, genomeFile, genomeReader, streamLength, numThreads, batchSize,
+                                            chunkReport);
+            }
+            else if(sortedArray != NULL)
+            {
+                scanResult = streamGenome(*sortedArray, genomeFile, genomeReader, streamLength, numThreads, batchSize,
+                                            chunkReport);
+            }
+            else if(flatTable != NULL)
+            {
+                scanResult = streamGenome(*flatTable, genomeFile, genomeReader, streamLength, numThreads, batchSize,
+                                            chunkReport);
+            }
+            else
+            {
+                scanResult = streamGenome(*chainTable, genomeFile, genomeReader, streamLength, numThreads, batchSize,
+                                            chunkReport);
+            }
+            if(PerfCounters::countingFlag)
+            {
+                searchCounters.stopCounters();
+            }
+
+            //Check for end timer before anything is printed
+            if(searchTimerFlag)
+            {
+                gettimeofday( &searchEndTime, NULL);
+            }
+            cout << scanResult.numWindows << " Substrings searched" << endl;
+        }
+        else
+        {
+            cout << "Reading Genome File" << endl;
+            if(PerfCounters::countingFlag)
+            {
+                loadCounters.startCounters(true);
+            }
+            genomeReader.readFile(genomeFile);
+            if(PerfCounters::countingFlag)
+            {
+                loadCounters.stopCounters();
+            }
+            genomeString = genomeReader.sequenceBuffer;
+            unsigned long long genomeLength = genomeReader.sequenceLength;
+
+            cout << "Searching Genome String" << endl;
+
+            //For each 16-mer in genome, search for match in query table
+            unsigned long long numSubstrings = 0;
+            if(genomeLength >= QUERY_LENGTH)
+            {
+                numSubstrings = genomeLength - QUERY_LENGTH + 1;
+            }
+            cout << numSubstrings << " Substrings to search" << endl;
+
+            //Check for start timer
+            if(searchTimerFlag)
+            {
+                gettimeofday( &searchStartTime, NULL);
+            }
+            if(PerfCounters::countingFlag)
+            {
+                searchCounters.startCounters(true);
+            }
+
+            //Search genome using selected query table
+            if(approxTable != NULL)
+            {
+                scanResult = searchGenome(*approxTable, genomeString, numSubstrings, numThreads, batchSize);
+            }
+            else if(bitmapTable != NULL)
+            {
+                scanResult = searchGenome(*bitmapTable, genomeString, numSubstrings, numThreads, batchSize);
+            }
+            else if(perfectTable != NULL)
+            {
+                scanResult = searchGenome(*perfectTable, genomeString, numSubstrings, numThreads, batchSize);
+            }
+            else if(sortedArray != NULL)
+            {
+                scanResult = searchGenome(*sortedArray, genomeString, numSubstrings, numThreads, batchSize);
+            }
+            else if(flatTable != NULL)
+            {
+                scanResult = searchGenome(*flatTable, genomeString, numSubstrings, numThreads, batchSize);
+            }
+            else
+            {
+                scanResult = searchGenome(*chainTable, genomeString, numSubstrings, numThreads, batchSize);
+            }
+            if(PerfCounters::countingFlag)
+            {
+                searchCounters.stopCounters();
+            }
+
+            //Check for end timer before anything is printed
+            if(searchTimerFlag)
+            {
+                gettimeofday( &searchEndTime, NULL);
+            }
+        }
+        numMatches = scanResult.numMatches;
+
+        //Print first matching fragments, rebuilt from their radix values
+        KmerEncoder printEncoder;
+        for(unsigned int matchIndex = 0; matchIndex < numMatches && matchIndex < MAX_PRINTED_MATCHES; matchIndex++)
+        {
+            char tempPrint[QUERY_LENGTH + 1];
+            printEncoder.decodeKey(scanResult.matchKeys[matchIndex], tempPrint);
+            cout << "Fragment " << (matchIndex + 1) << " " << tempPrint << endl;
+        }
+        cout << numMatches << " matches found" << endl;
+
+        //Report how many windows prefilter kept away from table, backends without one count none
+        if(scanResult.prefilterPasses + scanResult.prefilterRejects > 0)
+        {
+            cout << scanResult.prefilterRejects << " windows rejected by prefilter, "
+                    << scanResult.prefilterPasses << " passed ("
+                    << (scanResult.prefilterPasses - numMatches) << " false positives)" << endl;
+        }
+
+        //Print search time
+        if(searchTimerFlag)
+        {
+            printElapsed(searchStartTime, searchEndTime, "search the hash table");
+
+            //Compare cost of near matches against exact search on same genome
+            if(approxTable != NULL && genomeString != NULL)
+            {
+                benchmarkApprox(*approxTable, queryFile, genomeString, scanResult.numWindows, numThreads);
+            }
+
+            //Compare perfect hash against chained table on same genome
+            if(perfectTable != NULL && genomeString != NULL)
+            {
+                benchmarkPerfect(*perfectTable, queryFile, genomeString, scanResult.numWindows, numThreads);
+            }
+        }
+
+        //Report where large buffers ended up, huge pages fall back silently
+        if(PagePolicy::pageMode == PAGES_HUGE || PagePolicy::interleaveFlag)
+        {
+            cout << "Large buffers: " << PagePolicy::hugeBytes << " bytes on huge pages, "
+                    << PagePolicy::transparentBytes << " advised for transparent huge pages, "
+                    << PagePolicy::normalBytes << " on normal pages" << endl;
+        }
+
+        //Print counters of each phase, then of each scan thread
+        if(PerfCounters::countingFlag)
+        {
+            buildCounters.printCounters(cout, "Build");
+            if(streamLength == 0)
+            {
+                loadCounters.printCounters(cout, "Genome load");
+                searchCounters.printCounters(cout, "Search");
+            }
+            else
+            {
+                searchCounters.printCounters(cout, "Search and genome load");
+            }
+            for(unsigned int threadIndex = 0; threadIndex < scanResult.threadCounters.size(); threadIndex++)
+            {
+                string threadName = "  Scan thread " + to_string(threadIndex);
+                scanResult.threadCounters[threadIndex].printCounters(cout, threadName.c_str());
+            }
+        }
+
+        //Measure chained table, looking up genome again when it is held in memory
+        if((statsFlag || statsPath != NULL) && chainTable != NULL)
+        {
+            TableStats tableStats;
+            chainTable->collectStats(tableStats);
+            if(genomeString != NULL)
+            {
+                chainTable->probeGenome(genomeString, scanResult.numWindows, tableStats);
+            }
+            if(statsFlag)
+            {
+                tableStats.printStats(cout);
+            }
+            if(statsPath != NULL && !tableStats.writeJSON(statsPath))
+            {
+                cout << "Could not write stats file " << statsPath << endl;
+            }
+        }
+        else if(statsFlag || statsPath != NULL)
+        {
+            cout << "Table stats are only kept for chained table" << endl;
+        }
+
+        //Write every match as genome record, offset in record, query record and strand
+        //Streamed genomes were written chunk by chunk during search
+        if(reportPath != NULL)
+        {
+            if(streamLength == 0)
+            {
+                matchReport.writeMatches(scanResult, genomeReader);
+            }
+            if(matchReport.closeReport())
+            {
+                cout << matchReport.numWritten << " matches written to " << reportPath << endl;
+            }
+            else
+            {
+                cout << "Could not write match file " << reportPath << endl;
+            }
+        }
+
+        cout << "Clearing Hash" << endl;
+        delete chainTable;
+        delete flatTable;
+        delete sortedArray;
+        delete approxTable;
+        delete perfectTable;
+        delete bitmapTable;
+    }
+    else
+    {
+        cout << "Genome or Query File not found" << endl;
+        cout << "Please check your file names and try again" << endl;
+        return 1;
+    }
+    cout << "Program End" << endl;
+    return 0;
+}
@@ -0,0 +1,452 @@
+//Benchmark for table build and genome scan
+//Sweeps query count, genome size, load factor and backend over seeded random data
+//and writes one tab separated line per configuration so runs can be compared
+//
+//Usage: GenomicQueryBench [-q counts] [-g lengths] [-l factors] [-b backends]
+//                         [-n runs] [-w warmups] [-t threads] [-B batch] [-S seed] [-o file]
+//Lists are comma separated, for example -q 10000,1000000 -b chain,flat
+
+#include "GenomicQueryExMain.cpp"
+#include <sys/resource.h>
+#include <fstream>
+
+#define BENCH_SEED 567
+#define BENCH_RUNS 5
+#define BENCH_WARMUPS 1
+#define PLANTED_FRACTION 0.1
+
+class BenchResult
+{
+    public:
+
+    //Table size actually used, number of queries for other backends
+    unsigned long long tableSize;
+
+    //Build and scan time of each timed run in microseconds
+    vector<long long> buildUSecs;
+    vector<long long> scanUSecs;
+
+    //Matches found by last run
+    unsigned long long numMatches;
+
+    //Largest resident set seen while configuration ran, in kilobytes
+    long peakRSS;
+};
+
+//Function to find value below which given fraction of sorted times fall
+long long findPercentile(vector<long long> timeArray, double fraction);
+
+//Function to clear peak resident set so next configuration starts fresh
+void resetPeakRSS();
+
+//Function to find peak resident set in kilobytes
+long findPeakRSS();
+
+//Function to split comma separated list of numbers
+vector<double> parseList(const char *listString);
+
+//Function to time building and scanning with one backend, load factor is used by sized tables only
+BenchResult runBackend(unsigned int backendType, FILE *queryFile, unsigned int numQueries, double loadFactor,
+                    const char *genomeString, unsigned long long genomeLength, unsigned int numRuns,
+                    unsigned int numWarmups, unsigned int numThreads, unsigned int batchSize);
+
+int main(int argc, char **argv)
+{
+    //Initialize variables
+    vector<double> queryCounts = parseList("10000,100000,1000000");
+    vector<double> genomeLengths = parseList("1000000,10000000");
+    vector<double> loadFactors = parseList("0.25,0.5,0.75");
+    vector<unsigned int> backendTypes;
+    unsigned int numRuns = BENCH_RUNS;
+    unsigned int numWarmups = BENCH_WARMUPS;
+    unsigned int numThreads = 1;
+    unsigned int batchSize = DEFAULT_BATCH;
+    unsigned int seedValue = BENCH_SEED;
+    const char *outputPath = NULL;
+    const char *backendNames[] = {"chain", "flat", "sorted", "approx", "perfect", "bitmap"};
+
+    int argIndex = 1;
+    while(argIndex + 1 < argc)
+    {
+        if(compareString(argv[argIndex], "-q") == 0)
+        {
+            queryCounts = parseList(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-g") == 0)
+        {
+            genomeLengths = parseList(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-l") == 0)
+        {
+            loadFactors = parseList(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-b") == 0)
+        {
+            //Backends are named, walk list by hand
+            const char *wkgName = argv[argIndex + 1];
+            while(*wkgName != '\0')
+            {
+                for(unsigned int nameIndex = 0; nameIndex < 6; nameIndex++)
+                {
+                    unsigned int nameLength = strlen(backendNames[nameIndex]);
+                    if(strncmp(wkgName, backendNames[nameIndex], nameLength) == 0
+                            && (wkgName[nameLength] == ',' || wkgName[nameLength] == '\0'))
+                    {
+                        backendTypes.push_back(nameIndex);
+                    }
+                }
+                while(*wkgName != ',' && *wkgName != '\0')
+                {
+                    wkgName++;
+                }
+                if(*wkgName == ',')
+                {
+                    wkgName++;
+                }
+            }
+        }
+        else if(compareString(argv[argIndex], "-n") == 0)
+        {
+            numRuns = (unsigned int)atoi(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-w") == 0)
+        {
+            numWarmups = (unsigned int)atoi(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-t") == 0)
+        {
+            numThreads = (unsigned int)atoi(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-B") == 0)
+        {
+            batchSize = (unsigned int)atoi(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-S") == 0)
+        {
+            seedValue = (unsigned int)strtoul(argv[argIndex + 1], NULL, 10);
+        }
+        else if(compareString(argv[argIndex], "-o") == 0)
+        {
+            outputPath = argv[argIndex + 1];
+        }
+        argIndex += 2;
+    }
+
+    //Keep settings in range
+    if(backendTypes.empty())
+    {
+        backendTypes = {BACKEND_CHAIN, BACKEND_FLAT, BACKEND_SORTED, BACKEND_APPROX};
+    }
+    numRuns = (numRuns == 0) ? 1 : numRuns;
+    numThreads = (numThreads == 0) ? 1 : numThreads;
+    batchSize = (batchSize == 0) ? 1 : ((batchSize > MAX_BATCH) ? MAX_BATCH : batchSize);
+
+    //Write results to file when requested, otherwise to standard output
+    ofstream outputFile;
+    if(outputPath != NULL)
+    {
+        outputFile.open(outputPath);
+        if(!outputFile)
+        {
+            cerr << "Could not open " << outputPath << endl;
+            return 1;
+        }
+    }
+    ostream &benchOutput = (outputPath != NULL) ? outputFile : cout;
+
+    //Header names every column, times are microseconds and rates use median times
+    benchOutput << "backend\tqueries\tgenome_bases\tload_factor\ttable_size\truns\tthreads\tbatch"
+                << "\tbuild_median_us\tbuild_p99_us\tbuild_queries_per_s"
+                << "\tscan_median_us\tscan_p99_us\tscan_bases_per_s\tmatches\texpected_matches\tpeak_rss_kb" << endl;
+
+    for(unsigned int genomeIndex = 0; genomeIndex < genomeLengths.size(); genomeIndex++)
+    {
+        unsigned long long genomeLength = (unsigned long long)genomeLengths[genomeIndex];
+        if(genomeLength < QUERY_LENGTH)
+        {
+            continue;
+        }
+
+        for(unsigned int queryIndex = 0; queryIndex < queryCounts.size(); queryIndex++)
+        {
+            unsigned int numQueries = (unsigned int)queryCounts[queryIndex];
+            if(numQueries == 0)
+            {
+                continue;
+            }
+
+            //Same seed gives same genome and queries on every run of benchmark
+            WorkloadGenerator workloadGenerator(seedValue);
+            workloadGenerator.genomeLength = genomeLength;
+            workloadGenerator.numQueries = numQueries;
+            workloadGenerator.plantedFraction = PLANTED_FRACTION;
+            FILE *genomeFile = tmpfile();
+            FILE *queryFile = tmpfile();
+            if(genomeFile == NULL || queryFile == NULL || !workloadGenerator.generate(genomeFile, queryFile))
+            {
+                cerr << "Could not create workload files" << endl;
+                return 1;
+            }
+            rewind(genomeFile);
+            rewind(queryFile);
+            FastaReader genomeReader;
+            genomeReader.readFile(genomeFile);
+            const char *genomeString = genomeReader.sequenceBuffer;
+
+            for(unsigned int backendIndex = 0; backendIndex < backendTypes.size(); backendIndex++)
+            {
+                unsigned int backendType = backendTypes[backendIndex];
+                //Only chained and flat tables have a table size to sweep, others run once
+                bool sizedFlag = (backendType == BACKEND_CHAIN || backendType == BACKEND_FLAT);
+                unsigned int numFactors = sizedFlag ? loadFactors.size() : 1;
+                for(unsigned int factorIndex = 0; factorIndex < numFactors; factorIndex++)
+                {
+                    double loadFactor = loadFactors[factorIndex];
+                    if(loadFactor <= 0.0 || loadFactor >= 1.0)
+                    {
+                        loadFactor = DEFAULT_LOAD_FACTOR;
+                    }
+
+                    BenchResult benchResult = runBackend(backendType, queryFile, numQueries, loadFactor,
+                                                    genomeString, genomeLength, numRuns, numWarmups,
+                                                    numThreads, batchSize);
+
+                    long long buildMedian = findPercentile(benchResult.buildUSecs, 0.5);
+                    long long scanMedian = findPercentile(benchResult.scanUSecs, 0.5);
+                    unsigned long long numWindows = genomeLength - QUERY_LENGTH + 1;
+
+                    benchOutput << backendNames[backendType] << "\t" << numQueries << "\t" << genomeLength << "\t";
+                    if(sizedFlag)
+                    {
+                        benchOutput << loadFactor;
+                    }
+                    else
+                    {
+                        benchOutput << "-";
+                    }
+                    benchOutput << "\t" << benchResult.tableSize << "\t" << numRuns << "\t" << numThreads
+                                << "\t" << batchSize
+                                << "\t" << buildMedian << "\t" << findPercentile(benchResult.buildUSecs, 0.99)
+                                << "\t" << (unsigned long long)(numQueries * 1000000.0 / (buildMedian > 0 ? buildMedian : 1))
+                                << "\t" << scanMedian << "\t" << findPercentile(benchResult.scanUSecs, 0.99)
+                                << "\t" << (unsigned long long)(numWindows * 1000000.0 / (scanMedian > 0 ? scanMedian : 1))
+                                << "\t" << benchResult.numMatches << "\t" << workloadGenerator.expectedMatches
+                                << "\t" << benchResult.peakRSS << endl;
+                }
+            }
+            fclose(queryFile);
+            fclose(genomeFile);
+        }
+    }
+
+    return 0;
+}
+
+long long findPercentile(vector<long long> timeArray, double fraction)
+{
+    //Nearest rank, so p99 of few runs is slowest run
+    if(timeArray.empty())
+    {
+        return 0;
+    }
+    sort(timeArray.begin(), timeArray.end());
+    unsigned long long rankIndex = (unsigned long long)(fraction * timeArray.size() + 0.999999);
+    rankIndex = (rankIndex == 0) ? 0 : rankIndex - 1;
+    if(rankIndex >= timeArray.size())
+    {
+        rankIndex = timeArray.size() - 1;
+    }
+    return timeArray[rankIndex];
+}
+
+void resetPeakRSS()
+{
+    //Linux resets peak resident set when 5 is written here, other systems keep process peak
+    FILE *refsFile = fopen("/proc/self/clear_refs", "w");
+    if(refsFile != NULL)
+    {
+        fputs("5", refsFile);
+        fclose(refsFile);
+    }
+}
+
+long findPeakRSS()
+{
+    //Read peak resident set from status file when it is available
+    FILE *statusFile = fopen("/proc/self/status", "r");
+    if(statusFile != NULL)
+    {
+        char statusLine[256];
+        while(fgets(statusLine, sizeof(statusLine), statusFile) != NULL)
+        {
+            if(strncmp(statusLine, "VmHWM:", 6) == 0)
+            {
+                fclose(statusFile);
+                return atol(statusLine + 6);
+            }
+        }
+        fclose(statusFile);
+    }
+
+    //Otherwise use peak of whole process
+    struct rusage processUsage;
+    getrusage(RUSAGE_SELF, &processUsage);
+    return processUsage.ru_maxrss;
+}
+
+vector<double> parseList(const char *listString)
+{
+    //Initialize function/variables
+    vector<double> listValues;
+    char *wkgPtr = (char *)listString;
+
+    //Read numbers until end of string, skipping commas
+    while(*wkgPtr != '\0')
+    {
+        char *endPtr;
+        double listValue = strtod(wkgPtr, &endPtr);
+        if(endPtr == wkgPtr)
+        {
+            break;
+        }
+        listValues.push_back(listValue);
+        wkgPtr = (*endPtr == ',') ? endPtr + 1 : endPtr;
+    }
+    return listValues;
+}
+
+//Function to find size of built table for report
+//Hashed tables report list heads or slots, others report stored queries
+unsigned long long findSize(Queries_HT &queryTable)
+{
+    return queryTable.hashTableSize;
+}
+
+unsigned long long findSize(Queries_FlatHT &queryTable)
+{
+    return queryTable.hashTableSize;
+}
+
+unsigned long long findSize(Queries_Sorted &queryTable)
+{
+    return queryTable.numQueries;
+}
+
+unsigned long long findSize(Queries_Perfect &queryTable)
+{
+    return queryTable.numQueries;
+}
+
+unsigned long long findSize(Queries_Bitmap &queryTable)
+{
+    return queryTable.numQueries;
+}
+
+unsigned long long findSize(Queries_Approx &queryTable)
+{
+    return queryTable.numQueries;
+}
+
+//Function to scan genome with table built since buildStartTime, then free table
+//Warm-up runs fill caches and page in memory, their times are not reported
+template <class QueryTable>
+void timeScan(BenchResult &benchResult, QueryTable *queryTable, const struct timeval &buildStartTime, bool reportFlag,
+                const char *genomeString, unsigned long long genomeLength, unsigned int numThreads,
+                unsigned int batchSize)
+{
+    struct timeval scanStartTime, scanEndTime;
+    gettimeofday( &scanStartTime, NULL);
+    ScanResult scanResult = searchGenome(*queryTable, genomeString, genomeLength - QUERY_LENGTH + 1,
+                                            numThreads, batchSize);
+    gettimeofday( &scanEndTime, NULL);
+
+    if(reportFlag)
+    {
+        benchResult.buildUSecs.push_back(elapsedUSecs(buildStartTime, scanStartTime));
+        benchResult.scanUSecs.push_back(elapsedUSecs(scanStartTime, scanEndTime));
+    }
+    benchResult.numMatches = scanResult.numMatches;
+    benchResult.tableSize = findSize(*queryTable);
+    delete queryTable;
+}
+
+//Function to time warm-up and timed runs of backend that sizes itself from stored queries
+template <class QueryTable>
+void timeRuns(BenchResult &benchResult, FILE *queryFile, const char *genomeString,
+                unsigned long long genomeLength, unsigned int numRuns, unsigned int numWarmups,
+                unsigned int numThreads, unsigned int batchSize)
+{
+    for(unsigned int runIndex = 0; runIndex < numWarmups + numRuns; runIndex++)
+    {
+        //Every run builds fresh table so build time includes reading queries
+        struct timeval buildStartTime;
+        gettimeofday( &buildStartTime, NULL);
+        QueryTable *queryTable = new QueryTable(queryFile);
+        queryTable->fillHashes(false);
+        timeScan(benchResult, queryTable, buildStartTime, runIndex >= numWarmups, genomeString, genomeLength,
+                    numThreads, batchSize);
+    }
+}
+
+//Function to time warm-up and timed runs of hashed table sized from load factor
+template <class QueryTable>
+void timeRuns(BenchResult &benchResult, FILE *queryFile, unsigned int numQueries, double loadFactor,
+                const char *genomeString, unsigned long long genomeLength, unsigned int numRuns,
+                unsigned int numWarmups, unsigned int numThreads, unsigned int batchSize)
+{
+    for(unsigned int runIndex = 0; runIndex < numWarmups + numRuns; runIndex++)
+    {
+        //Every run builds fresh table so build time includes reading queries
+        struct timeval buildStartTime;
+        gettimeofday( &buildStartTime, NULL);
+        QueryTable *queryTable = new QueryTable(queryFile, findTableSize(numQueries, loadFactor), loadFactor);
+        queryTable->fillHashes(false);
+        timeScan(benchResult, queryTable, buildStartTime, runIndex >= numWarmups, genomeString, genomeLength,
+                    numThreads, batchSize);
+    }
+}
+
+BenchResult runBackend(unsigned int backendType, FILE *queryFile, unsigned int numQueries, double loadFactor,
+                    const char *genomeString, unsigned long long genomeLength, unsigned int numRuns,
+                    unsigned int numWarmups, unsigned int numThreads, unsigned int batchSize)
+{
+    //Initialize function/variables
+    BenchResult benchResult;
+    benchResult.tableSize = 0;
+    benchResult.numMatches = 0;
+
+    //Peak covers genome, query file and tables of this configuration only
+    resetPeakRSS();
+    if(backendType == BACKEND_APPROX)
+    {
+        timeRuns<Queries_Approx>(benchResult, queryFile, genomeString, genomeLength,
+                                    numRuns, numWarmups, numThreads, batchSize);
+    }
+    else if(backendType == BACKEND_BITMAP)
+    {
+        timeRuns<Queries_Bitmap>(benchResult, queryFile, genomeString, genomeLength,
+                                    numRuns, numWarmups, numThreads, batchSize);
+    }
+    else if(backendType == BACKEND_PERFECT)
+    {
+        timeRuns<Queries_Perfect>(benchResult, queryFile, genomeString, genomeLength,
+                                    numRuns, numWarmups, numThreads, batchSize);
+    }
+    else if(backendType == BACKEND_SORTED)
+    {
+        timeRuns<Queries_Sorted>(benchResult, queryFile, genomeString, genomeLength,
+                                    numRuns, numWarmups, numThreads, batchSize);
+    }
+    else if(backendType == BACKEND_FLAT)
+    {
+        timeRuns<Queries_FlatHT>(benchResult, queryFile, numQueries, loadFactor, genomeString, genomeLength,
+                                    numRuns, numWarmups, numThreads, batchSize);
+    }
+    else
+    {
+        timeRuns<Queries_HT>(benchResult, queryFile, numQueries, loadFactor, genomeString, genomeLength,
+                                    numRuns, numWarmups, numThreads, batchSize);
+    }
+    benchResult.peakRSS = findPeakRSS();
+    return benchResult;
+}
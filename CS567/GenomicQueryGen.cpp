@@ -0,0 +1,94 @@
+//Generator for seeded synthetic genome and query files
+//Same seed and settings always write same files, so large workloads need not be shipped
+//
+//Usage: GenomicQueryGen <genome file> <query file> [-g length] [-q count] [-p planted]
+//                       [-d duplicate] [-n runs per Mb] [-L run length] [-S seed]
+//Prints settings and counts as tab separated name and value lines, including expected_matches
+
+#include "GenomicQueryExMain.cpp"
+
+int main(int argc, char **argv)
+{
+    //Initialize variables
+    WorkloadGenerator workloadGenerator(567);
+
+    if(argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " <genome file> <query file> [-g length] [-q count] [-p planted]"
+                << " [-d duplicate] [-n runs per Mb] [-L run length] [-S seed]" << endl;
+        return 1;
+    }
+
+    int argIndex = 3;
+    while(argIndex + 1 < argc)
+    {
+        if(compareString(argv[argIndex], "-g") == 0)
+        {
+            workloadGenerator.genomeLength = strtoull(argv[argIndex + 1], NULL, 10);
+        }
+        else if(compareString(argv[argIndex], "-q") == 0)
+        {
+            workloadGenerator.numQueries = strtoull(argv[argIndex + 1], NULL, 10);
+        }
+        else if(compareString(argv[argIndex], "-p") == 0)
+        {
+            workloadGenerator.plantedFraction = atof(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-d") == 0)
+        {
+            workloadGenerator.duplicateFraction = atof(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-n") == 0)
+        {
+            workloadGenerator.nRunRate = atof(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-L") == 0)
+        {
+            workloadGenerator.nRunLength = atof(argv[argIndex + 1]);
+        }
+        else if(compareString(argv[argIndex], "-S") == 0)
+        {
+            workloadGenerator.seedValue = strtoull(argv[argIndex + 1], NULL, 10);
+        }
+        argIndex += 2;
+    }
+
+    //Keep fractions and run length in range
+    if(workloadGenerator.plantedFraction < 0.0 || workloadGenerator.duplicateFraction < 0.0
+            || workloadGenerator.plantedFraction + workloadGenerator.duplicateFraction > 1.0)
+    {
+        cerr << "Planted and duplicate fractions must be positive and add to at most 1" << endl;
+        return 1;
+    }
+    if(workloadGenerator.nRunLength < 1.0)
+    {
+        workloadGenerator.nRunLength = 1.0;
+    }
+
+    FILE *genomeFile = fopen(argv[1], "w");
+    FILE *queryFile = fopen(argv[2], "w");
+    if(genomeFile == NULL || queryFile == NULL)
+    {
+        cerr << "Could not create output files" << endl;
+        return 1;
+    }
+
+    bool writeFlag = workloadGenerator.generate(genomeFile, queryFile);
+    writeFlag = (fclose(genomeFile) == 0) && writeFlag;
+    writeFlag = (fclose(queryFile) == 0) && writeFlag;
+    if(!writeFlag)
+    {
+        cerr << "Could not write output files" << endl;
+        return 1;
+    }
+
+    cout << "seed\t" << workloadGenerator.seedValue << endl;
+    cout << "genome_bases\t" << workloadGenerator.genomeLength << endl;
+    cout << "queries\t" << workloadGenerator.numQueries << endl;
+    cout << "planted\t" << workloadGenerator.numPlanted << endl;
+    cout << "duplicates\t" << workloadGenerator.numDuplicates << endl;
+    cout << "random\t" << workloadGenerator.numRandom << endl;
+    cout << "expected_matches\t" << workloadGenerator.expectedMatches << endl;
+
+    return 0;
+}
@@ -1,195 +1,901 @@
-
-
-#include <deepstate/DeepState.hpp>
-
-using namespace deepstate;
-
-#include "GenomicQueryExMain.cpp"
-#include <fcntl.h>
-#include <fstream>
-
-#define MAX_GENOME_LENGTH 1000000000
-#define MAX_NUM_QUERIES 100000
-#define MAX_STR_LEN 17
-#define INDEX_LENGTH 12
-#define IDENTIFIER_LENGTH 4
-
-/*
-TEST(String, StringLength)
-{
-    char *string = DeepState_CStr_C(MAX_STR_LEN, "ACGTN");
-    ASSERT_EQ(getStringLength(string), MAX_STR_LEN);
-}
-
-TEST(String, CompareStings)
-{
-    ASSERT_EQ(compareString("", ""), 0);
-    ASSERT_EQ(compareString("ATGGCGGTCCAGAAT", "ATGGCGGTCCAGAAT"), 0);
-}
-
-
-TEST(Hash, RadixConvert)
-{
-    Queries_HT TestHash;
-    char *zeroString = DeepState_CStr_C(MAX_STR_LEN, "N");
-    ASSERT_EQ(TestHash.convertToRadix(zeroString, 0, INDEX_LENGTH), 0u);
-}
-
-TEST(Hash, FindIndex)
-{
-    Queries_HT TestHash;
-    TestHash.numQueries = 1;
-    char *zeroString = DeepState_CStr_C(MAX_STR_LEN, "N");
-    ASSERT_EQ(TestHash.findHashIndex(zeroString, 0, IDENTIFIER_LENGTH), 0u);
-}
-
-TEST(Program, Construction)
-{
-    int fd;
-    FILE *queryFile;
-    fd = open("trimmedQuery.txt", O_RDONLY | O_EXCL);
-
-    ASSERT_NE(fd, -1);
-    queryFile = fopen("trimmedQuery.txt", "r");
-    Queries_HT sixtyMSize = Queries_HT(queryFile, 60000000);
-    unsigned int numCollisions = sixtyMSize.fillHashes(false);
-    ASSERT_GT(sixtyMSize.numQueries, 0);
-
-    fclose(queryFile);
- 
-}
-*/
-
-TEST(Program, Execution)
-{
-    int randomQuery = DeepState_Int64InRange(1, MAX_NUM_QUERIES);
-    int randomGenomeLength = DeepState_Int64InRange(QUERY_LENGTH, MAX_GENOME_LENGTH);
-    char **queries = (char**)malloc(sizeof(char*) * randomQuery);
-    char *genome = (char*)malloc(sizeof(char) * randomGenomeLength);
-    std::ofstream tempQueryFile("testQueryFile.txt", std::ofstream::binary);
-    std::ofstream tempGenomeFile("testGenomeFile.txt", std::ofstream::binary);
-    for(int index = 0; index < randomQuery; index++)
-    {
-        queries[index] = (char*)malloc(sizeof(char) * QUERY_LENGTH);
-        queries[index] = DeepState_CStr_C(QUERY_LENGTH, "ACGNT");
-        tempQueryFile.write(queries[index], sizeof(char)*QUERY_LENGTH);
-    }
-    genome = DeepState_CStr_C(randomGenomeLength, "ACGNT");
-    tempGenomeFile.write(genome, sizeof(char)*randomGenomeLength);
-
-    tempGenomeFile.close();
-    tempQueryFile.close();
-
-    FILE *queryFile = fopen("testQueryFile.txt", "r");
-    FILE *genomeFile = fopen("testGenomeFile.txt", "r");
-
-    Queries_HT sixtyMSize = Queries_HT(queryFile, 60000000);
-    unsigned int numCollisions = sixtyMSize.fillHashes(false);
-
-    ASSERT_GE(sixtyMSize.numQueries, randomQuery);
-
-    unsigned int genomeLength = 0;
-        unsigned int genomeIndex = 0;
-        int intChar = fgetc(genomeFile);
-        while(intChar != EOF)
-        {
-            //Increment length of genome
-            genomeLength += (intChar > 64 && intChar < 91);
-            intChar = fgetc(genomeFile);
-        }
-        ASSERT_EQ(genomeLength, randomGenomeLength) << randomGenomeLength;
-        char *genomeString = new char[genomeLength+1];
-        fseek(genomeFile, 0, SEEK_SET);
-        intChar = fgetc(genomeFile);
-
-        while(intChar != EOF)
-        {
-            if(intChar > 64 && intChar < 91)
-            {
-                //Increment length of genome
-                genomeString[genomeIndex] = (char)(intChar);
-                genomeIndex++;
-                genomeString[genomeIndex+1] = '\0';
-            }
-            intChar = fgetc(genomeFile);
-        }
-
-    unsigned int numSubstrings = genomeLength - QUERY_LENGTH + 1;
-    unsigned int numMatches = 0;
-
-    for(unsigned int index = 0; index < numSubstrings; index++)
-        {
-            //Check for successful search
-            if(sixtyMSize.searchHash(genomeString, index))
-            {
-                //Increment number of found matches
-                numMatches += 1;
-            }
-        }
-
-    fclose(genomeFile);
-    fclose(queryFile);
-}
-
-/*
-TEST(Program, Execution)
-{
-    int fdQuery, fdGenome;
-    fdQuery = open("trimmedQuery.txt", O_RDONLY | O_EXCL);
-    fdGenome = open("trimmedGenome.txt", O_RDONLY | O_EXCL);
-
-    ASSERT_NE(fdQuery, -1);
-    ASSERT_NE(fdGenome, -1);
-
-    FILE *queryFile = fopen("trimmedQuery.txt", "r");
-    FILE *genomeFile = fopen("trimmedGenome.txt", "r");
-
-    Queries_HT sixtyMSize = Queries_HT(queryFile, 60000000);
-    unsigned int numCollisions = sixtyMSize.fillHashes(false);
-
-    unsigned int genomeLength = 0;
-        unsigned int genomeIndex = 0;
-        int intChar = fgetc(genomeFile);
-        while(intChar != EOF)
-        {
-            //Increment length of genome
-            genomeLength += (intChar > 64 && intChar < 91);
-            intChar = fgetc(genomeFile);
-        }
-        ASSERT_GT(genomeLength, 0);
-        char *genomeString = new char[genomeLength+1];
-        fseek(genomeFile, 0, SEEK_SET);
-        intChar = fgetc(genomeFile);
-
-        while(intChar != EOF)
-        {
-            if(intChar > 64 && intChar < 91)
-            {
-                //Increment length of genome
-                genomeString[genomeIndex] = (char)(intChar);
-                genomeIndex++;
-                genomeString[genomeIndex+1] = '\0';
-            }
-            intChar = fgetc(genomeFile);
-        }
-
-    unsigned int numSubstrings = genomeLength - QUERY_LENGTH + 1;
-    unsigned int numMatches = 0;
-
-    for(unsigned int index = 0; index < numSubstrings; index++)
-        {
-            //Check for successful search
-            if(sixtyMSize.searchHash(genomeString, index))
-            {
-                //Increment number of found matches
-                numMatches += 1;
-            }
-        }
-
-    ASSERT_GT(numMatches, 0);
-
-    fclose(genomeFile);
-    fclose(queryFile);
-
-}
+
+
+#include <deepstate/DeepState.hpp>
+
+using namespace deepstate;
+
+#include "GenomicQueryExMain.cpp"
+#include <fcntl.h>
+#include <fstream>
+
+#define MAX_GENOME_LENGTH 1000000000
+#define MAX_NUM_QUERIES 100000
+#define MAX_STR_LEN 17
+#define INDEX_LENGTH 12
+#define IDENTIFIER_LENGTH 4
+
+/*
+TEST(String, StringLength)
+{
+    char *string = DeepState_CStr_C(MAX_STR_LEN, "ACGTN");
+    ASSERT_EQ(getStringLength(string), MAX_STR_LEN);
+}
+
+TEST(String, CompareStings)
+{
+    ASSERT_EQ(compareString("", ""), 0);
+    ASSERT_EQ(compareString("ATGGCGGTCCAGAAT", "ATGGCGGTCCAGAAT"), 0);
+}
+
+
+TEST(Hash, RadixConvert)
+{
+    Queries_HT TestHash;
+    char *zeroString = DeepState_CStr_C(MAX_STR_LEN, "N");
+    ASSERT_EQ(TestHash.convertToRadix(zeroString, 0, INDEX_LENGTH), 0u);
+}
+
+TEST(Hash, FindIndex)
+{
+    Queries_HT TestHash;
+    TestHash.numQueries = 1;
+    char *zeroString = DeepState_CStr_C(MAX_STR_LEN, "N");
+    ASSERT_EQ(TestHash.findHashIndex(zeroString, 0, IDENTIFIER_LENGTH), 0u);
+}
+
+TEST(Program, Construction)
+{
+    int fd;
+    FILE *queryFile;
+    fd = open("trimmedQuery.txt", O_RDONLY | O_EXCL);
+
+    ASSERT_NE(fd, -1);
+    queryFile = fopen("trimmedQuery.txt", "r");
+    Queries_HT sixtyMSize = Queries_HT(queryFile, 60000000);
+    unsigned int numCollisions = sixtyMSize.fillHashes(false);
+    ASSERT_GT(sixtyMSize.numQueries, 0);
+
+    fclose(queryFile);
+ 
+}
+*/
+
+TEST(Hash, InvalidCharacter)
+{
+    //Query repeats character before invalid position, so reusing last value would match
+    Queries_HT TestHash = Queries_HT(NULL, 64);
+    char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGT");
+    int invalidIndex = DeepState_Int64InRange(1, QUERY_LENGTH - 1);
+    query[invalidIndex] = query[invalidIndex - 1];
+    TestHash.insertSequence(query);
+
+    //Record separator and other characters outside NATCG must never match
+    char window[QUERY_LENGTH + 1];
+    memcpy(window, query, QUERY_LENGTH + 1);
+    ASSERT(TestHash.searchHash(window, 0));
+    window[invalidIndex] = "|x-*"[DeepState_Int64InRange(0, 3)];
+    ASSERT(!TestHash.searchHash(window, 0));
+    ASSERT_EQ(TestHash.convertToRadix(window, invalidIndex, 1), INVALID_QUERY);
+}
+
+TEST(Hash, FlatTable)
+{
+    int randomQuery = DeepState_Int64InRange(1, 1000);
+    Queries_FlatHT flatTable = Queries_FlatHT(NULL, 4096);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGNT");
+        flatTable.insertSequence(query);
+        ASSERT(flatTable.searchHash(query, 0)) << query;
+    }
+    ASSERT_LE(flatTable.numQueries, randomQuery);
+    ASSERT_GT(flatTable.numQueries, 0);
+}
+
+TEST(Hash, SortedArray)
+{
+    int randomQuery = DeepState_Int64InRange(1, 300);
+    FILE *queryFile = tmpfile();
+    Queries_FlatHT flatTable = Queries_FlatHT(NULL, 1024);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGT");
+        fprintf(queryFile, ">query%d\n%s\n", index, query);
+        flatTable.insertSequence(query);
+    }
+    rewind(queryFile);
+    Queries_Sorted sortedArray = Queries_Sorted(queryFile);
+    sortedArray.fillHashes(false);
+    fclose(queryFile);
+    ASSERT_EQ(sortedArray.numQueries, flatTable.numQueries);
+
+    //Sorted array must agree with flat table on random windows
+    char *sequence = DeepState_CStr_C(200, "ACGNT");
+    for(int index = 0; index + QUERY_LENGTH <= 200; index++)
+    {
+        ASSERT_EQ(sortedArray.searchHash(sequence, index), flatTable.searchHash(sequence, index)) << index;
+    }
+    for(unsigned int index = 1; index <= sortedArray.numQueries; index++)
+    {
+        ASSERT(sortedArray.searchKey(sortedArray.keyArray[index])) << index;
+    }
+}
+
+TEST(Hash, PerfectHash)
+{
+    int randomQuery = DeepState_Int64InRange(1, 300);
+    FILE *queryFile = tmpfile();
+    Queries_FlatHT flatTable = Queries_FlatHT(NULL, 1024);
+    unsigned long long keyArray[300];
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGT");
+        bool validFlag = true;
+        fprintf(queryFile, ">query%d\n%s\n", index, query);
+        flatTable.insertSequence(query);
+        keyArray[index] = flatTable.queryEncoder.encodeWindow(query, 0, validFlag);
+    }
+    rewind(queryFile);
+    Queries_Perfect perfectTable = Queries_Perfect(queryFile);
+    perfectTable.fillHashes(false);
+    fclose(queryFile);
+    ASSERT_EQ(perfectTable.numQueries, flatTable.numQueries);
+
+    //Every query must be found, and distinct queries must take every index exactly once
+    std::vector<bool> usedIndexes(perfectTable.numQueries, false);
+    unsigned int numUsed = 0;
+    for(int index = 0; index < randomQuery; index++)
+    {
+        ASSERT(perfectTable.searchKey(keyArray[index])) << index;
+        unsigned int keyIndex = perfectTable.findIndex(keyArray[index]);
+        ASSERT_LT(keyIndex, perfectTable.numQueries) << index;
+        if(!usedIndexes[keyIndex])
+        {
+            usedIndexes[keyIndex] = true;
+            numUsed++;
+        }
+    }
+    if(perfectTable.fallbackKeys.empty())
+    {
+        ASSERT_EQ(numUsed, perfectTable.numQueries);
+    }
+
+    //Perfect hash must agree with flat table on random windows
+    char *sequence = DeepState_CStr_C(200, "ACGNT");
+    for(int index = 0; index + QUERY_LENGTH <= 200; index++)
+    {
+        ASSERT_EQ(perfectTable.searchHash(sequence, index), flatTable.searchHash(sequence, index)) << index;
+    }
+}
+
+TEST(Hash, DirectBitmap)
+{
+    //Queries may hold N, which must take path beside bitmap
+    int randomQuery = DeepState_Int64InRange(1, 300);
+    bool canonicalFlag = DeepState_Bool();
+    FILE *queryFile = tmpfile();
+    Queries_FlatHT flatTable = Queries_FlatHT(NULL, 1024);
+    flatTable.queryEncoder.canonicalFlag = canonicalFlag;
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGNT");
+        fprintf(queryFile, ">query%d\n%s\n", index, query);
+        flatTable.insertSequence(query);
+    }
+    rewind(queryFile);
+    Queries_Bitmap bitmapTable = Queries_Bitmap(queryFile);
+    bitmapTable.queryEncoder.canonicalFlag = canonicalFlag;
+    bitmapTable.fillHashes(false);
+    fclose(queryFile);
+    ASSERT_EQ(bitmapTable.numQueries, flatTable.numQueries);
+
+    //Bitmap must agree with flat table on random windows, scanned and looked up one at a time
+    char *sequence = DeepState_CStr_C(300, "ACGNT");
+    for(int index = 0; index + QUERY_LENGTH <= 300; index++)
+    {
+        ASSERT_EQ(bitmapTable.searchHash(sequence, index), flatTable.searchHash(sequence, index)) << index;
+    }
+    ScanResult bitmapResult = searchGenome(bitmapTable, sequence, 300 - QUERY_LENGTH + 1, 1);
+    ScanResult flatResult = searchGenome(flatTable, sequence, 300 - QUERY_LENGTH + 1, 1);
+    ASSERT_EQ(bitmapResult.numMatches, flatResult.numMatches);
+}
+
+TEST(Hash, KmerEngine)
+{
+    //Plant random genome windows as 21 character queries
+    int randomQuery = DeepState_Int64InRange(1, 50);
+    char *sequence = DeepState_CStr_C(300, "ACGTN");
+    FILE *queryFile = tmpfile();
+    for(int index = 0; index < randomQuery; index++)
+    {
+        int queryStart = DeepState_Int64InRange(0, 300 - 21);
+        fprintf(queryFile, ">query%d\n%.21s\n", index, sequence + queryStart);
+    }
+    rewind(queryFile);
+    KmerTable<21> kmerTable;
+    kmerTable.fillKeys(queryFile);
+    fclose(queryFile);
+
+    //Rolling scan must agree with packing every window from scratch
+    unsigned int expectedMatches = 0;
+    for(int index = 0; index + 21 <= 300; index++)
+    {
+        KmerTable<21>::KeyType windowKey;
+        if(KmerTable<21>::encodeKmer(sequence + index, windowKey) && kmerTable.searchKey(windowKey))
+        {
+            expectedMatches += 1;
+        }
+    }
+    ASSERT_EQ(kmerTable.scanGenome(sequence, 300).numMatches, expectedMatches);
+    ASSERT_LE(kmerTable.numQueries + kmerTable.numInvalid, (unsigned int)randomQuery);
+}
+
+TEST(Hash, Canonical)
+{
+    //Plant random windows and their reverse complements as queries
+    char *sequence = DeepState_CStr_C(300, "ACGNT");
+    Queries_FlatHT forwardTable = Queries_FlatHT(NULL, 64);
+    Queries_FlatHT canonicalTable = Queries_FlatHT(NULL, 64);
+    canonicalTable.queryEncoder.canonicalFlag = true;
+    int randomQuery = DeepState_Int64InRange(1, 30);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = sequence + DeepState_Int64InRange(0, 300 - QUERY_LENGTH);
+        char reverseQuery[QUERY_LENGTH + 1];
+        bool validFlag = true;
+        forwardTable.queryEncoder.decodeKey(forwardTable.queryEncoder.reverseComplement(
+                            forwardTable.queryEncoder.encodeWindow(query, 0, validFlag)), reverseQuery);
+        char *plantedQuery = DeepState_Bool() ? reverseQuery : query;
+        forwardTable.insertSequence(plantedQuery);
+        canonicalTable.insertSequence(plantedQuery);
+    }
+
+    //Canonical lookup must find window when either strand is a query
+    unsigned long long expectedMatches = 0;
+    for(int index = 0; index + QUERY_LENGTH <= 300; index++)
+    {
+        bool validFlag = true;
+        unsigned long long windowKey = forwardTable.queryEncoder.encodeWindow(sequence, index, validFlag);
+        bool expectedFlag = validFlag && (forwardTable.searchKey(windowKey)
+                                || forwardTable.searchKey(forwardTable.queryEncoder.reverseComplement(windowKey)));
+        ASSERT_EQ(canonicalTable.searchHash(sequence, index), expectedFlag) << index;
+        expectedMatches += expectedFlag;
+    }
+
+    //Rolling canonical scan must agree with lookups from scratch
+    ASSERT_EQ(searchGenome(canonicalTable, sequence, 300 - QUERY_LENGTH + 1, 2).numMatches, expectedMatches);
+}
+
+TEST(Hash, Approximate)
+{
+    //Queries are random windows with one random substitution
+    char *sequence = DeepState_CStr_C(200, "ACGNT");
+    int randomQuery = DeepState_Int64InRange(1, 20);
+    char queryArray[20][QUERY_LENGTH + 1];
+    FILE *queryFile = tmpfile();
+    for(int index = 0; index < randomQuery; index++)
+    {
+        memcpy(queryArray[index], sequence + DeepState_Int64InRange(0, 200 - QUERY_LENGTH), QUERY_LENGTH);
+        queryArray[index][DeepState_Int64InRange(0, QUERY_LENGTH - 1)] = "ACGNT"[DeepState_Int64InRange(0, 4)];
+        queryArray[index][QUERY_LENGTH] = '\0';
+        fprintf(queryFile, ">query%d\n%s\n", index, queryArray[index]);
+    }
+    rewind(queryFile);
+    Queries_Approx approxTable = Queries_Approx(queryFile);
+    approxTable.fillHashes(false);
+    fclose(queryFile);
+
+    //Window matches when some query differs from it in at most one character
+    for(int index = 0; index + QUERY_LENGTH <= 200; index++)
+    {
+        bool expectedFlag = false;
+        for(int queryIndex = 0; queryIndex < randomQuery; queryIndex++)
+        {
+            int numDiffs = 0;
+            for(int charIndex = 0; charIndex < QUERY_LENGTH; charIndex++)
+            {
+                numDiffs += (sequence[index + charIndex] != queryArray[queryIndex][charIndex]);
+            }
+            expectedFlag = expectedFlag || (numDiffs <= 1);
+        }
+        ASSERT_EQ(approxTable.searchHash(sequence, index), expectedFlag) << index;
+    }
+}
+
+TEST(Hash, BatchedLookup)
+{
+    //Queries are random windows of genome so some lookups hit
+    char *sequence = DeepState_CStr_C(300, "ACGNT");
+    int randomQuery = DeepState_Int64InRange(1, 50);
+    unsigned int batchSize = DeepState_Int64InRange(2, MAX_BATCH);
+    FILE *queryFile = tmpfile();
+    for(int index = 0; index < randomQuery; index++)
+    {
+        fprintf(queryFile, ">query%d\n%.*s\n", index, QUERY_LENGTH,
+                    sequence + DeepState_Int64InRange(0, 300 - QUERY_LENGTH));
+    }
+    rewind(queryFile);
+    unsigned int tableSize = findTableSize(countQueries(queryFile), DEFAULT_LOAD_FACTOR);
+    Queries_HT chainTable = Queries_HT(queryFile, tableSize);
+    Queries_FlatHT flatTable = Queries_FlatHT(queryFile, tableSize);
+    chainTable.fillHashes(false);
+    flatTable.fillHashes(false);
+    fclose(queryFile);
+
+    //Batched scan must report same windows in same order as one lookup at a time
+    ScanResult chainSingle = searchGenome(chainTable, sequence, 300 - QUERY_LENGTH + 1, 1, 1);
+    ScanResult chainBatched = searchGenome(chainTable, sequence, 300 - QUERY_LENGTH + 1, 1, batchSize);
+    ScanResult flatSingle = searchGenome(flatTable, sequence, 300 - QUERY_LENGTH + 1, 1, 1);
+    ScanResult flatBatched = searchGenome(flatTable, sequence, 300 - QUERY_LENGTH + 1, 1, batchSize);
+    ASSERT_EQ(chainBatched.numMatches, chainSingle.numMatches);
+    ASSERT_EQ(flatBatched.numMatches, flatSingle.numMatches);
+    ASSERT_EQ(flatSingle.numMatches, chainSingle.numMatches);
+    ASSERT_GT(chainSingle.numMatches, 0);
+    for(unsigned long long index = 0; index < chainSingle.numMatches; index++)
+    {
+        ASSERT_EQ(chainBatched.matchPositions[index], chainSingle.matchPositions[index]) << index;
+        ASSERT_EQ(chainBatched.matchKeys[index], chainSingle.matchKeys[index]) << index;
+        ASSERT_EQ(flatBatched.matchPositions[index], chainSingle.matchPositions[index]) << index;
+    }
+}
+
+TEST(Hash, InterleavedLookup)
+{
+    //Few list heads and high load factor give long lists with several hops
+    int randomQuery = DeepState_Int64InRange(1, 500);
+    Queries_HT chainTable = Queries_HT(NULL, 4, 64.0);
+    unsigned long long keyArray[1000];
+    bool interleavedResults[1000];
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGT");
+        bool validFlag = true;
+        chainTable.insertSequence(query);
+
+        //Look up each query and a copy with one random digit changed
+        keyArray[2 * index] = chainTable.queryEncoder.encodeWindow(query, 0, validFlag);
+        query[DeepState_Int64InRange(0, QUERY_LENGTH - 1)] = "ACGT"[DeepState_Int64InRange(0, 3)];
+        keyArray[2 * index + 1] = chainTable.queryEncoder.encodeWindow(query, 0, validFlag);
+    }
+
+    //Interleaved lookups must agree with synchronous search for every key
+    chainTable.searchInterleaved(keyArray, 2 * randomQuery, interleavedResults);
+    for(int index = 0; index < 2 * randomQuery; index++)
+    {
+        ASSERT_EQ(interleavedResults[index], chainTable.searchKey(keyArray[index])) << index;
+    }
+    for(int index = 0; index < randomQuery; index++)
+    {
+        ASSERT(interleavedResults[2 * index]) << index;
+    }
+}
+
+TEST(Hash, TableStats)
+{
+    //Queries are random windows of genome so some lookups hit
+    char *sequence = DeepState_CStr_C(500, "ACGNTR");
+    int randomQuery = DeepState_Int64InRange(1, 100);
+    Queries_HT chainTable = Queries_HT(NULL, findTableSize(randomQuery, DEFAULT_LOAD_FACTOR));
+    for(int index = 0; index < randomQuery; index++)
+    {
+        chainTable.insertSequence(sequence + DeepState_Int64InRange(0, 500 - QUERY_LENGTH));
+    }
+
+    //Histogram must account for every list and every node
+    TableStats tableStats;
+    chainTable.collectStats(tableStats);
+    unsigned long long numLists = 0;
+    unsigned long long numNodes = 0;
+    for(unsigned int index = 0; index < tableStats.chainHistogram.size(); index++)
+    {
+        numLists += tableStats.chainHistogram[index];
+        numNodes += index * tableStats.chainHistogram[index];
+    }
+    ASSERT_EQ(numLists, chainTable.hashTableSize);
+    ASSERT_EQ(numNodes, chainTable.numQueries);
+    ASSERT_EQ(tableStats.usedBuckets, chainTable.hashTableSize - tableStats.chainHistogram[0]);
+    ASSERT_GE(tableStats.longestChain * tableStats.usedBuckets, chainTable.numQueries);
+
+    //Probe counts must agree with scan
+    chainTable.probeGenome(sequence, 500 - QUERY_LENGTH + 1, tableStats);
+    ScanResult scanResult = searchGenome(chainTable, sequence, 500 - QUERY_LENGTH + 1, 1);
+    ASSERT_EQ(tableStats.numHits, scanResult.numMatches);
+    ASSERT_GE(tableStats.numProbes, tableStats.numHits);
+    ASSERT_LE(tableStats.numLookups, 500 - QUERY_LENGTH + 1);
+}
+
+TEST(Hash, PagePolicy)
+{
+    //Buffers must come back zeroed and usable under every policy
+    unsigned long long numBytes = DeepState_Int64InRange(1, 8 << 20);
+    PagePolicy::pageMode = DeepState_Bool() ? PAGES_HUGE : PAGES_NORMAL;
+    PagePolicy::interleaveFlag = DeepState_Bool();
+    char *bufferData = (char *)PagePolicy::allocateBuffer(numBytes);
+    ASSERT(bufferData != NULL);
+    ASSERT_GE(PagePolicy::mappedLength(numBytes), numBytes);
+    if(PagePolicy::pageMode == PAGES_HUGE && numBytes >= HUGE_PAGE_BYTES)
+    {
+        ASSERT_EQ((unsigned long long)bufferData % HUGE_PAGE_BYTES, 0);
+    }
+    for(unsigned long long index = 0; index < numBytes; index += 4093)
+    {
+        ASSERT_EQ(bufferData[index], 0) << index;
+        bufferData[index] = 1;
+    }
+    bufferData[numBytes - 1] = 1;
+    PagePolicy::releaseBuffer(bufferData, numBytes);
+
+    //Table built on policy buffers must hold every query
+    Queries_HT chainTable = Queries_HT(NULL, DeepState_Int64InRange(1, 1 << 20));
+    int randomQuery = DeepState_Int64InRange(1, 100);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        char *query = DeepState_CStr_C(QUERY_LENGTH, "ACGNT");
+        chainTable.insertSequence(query);
+        ASSERT(chainTable.searchHash(query, 0)) << query;
+    }
+    PagePolicy::pageMode = PAGES_NORMAL;
+    PagePolicy::interleaveFlag = false;
+}
+
+TEST(Hash, EncodeKernels)
+{
+    Queries_HT TestHash;
+    KmerEncoder testEncoder;
+    unsigned int bestLevel = testEncoder.simdLevel;
+    int randomLength = DeepState_Int64InRange(QUERY_LENGTH, 200);
+    char *sequence = DeepState_CStr_C(randomLength, "ACGNTR");
+    unsigned char scalarDigits[200];
+    unsigned char simdDigits[200];
+    unsigned int scalarInvalid = testEncoder.encodeBlockScalar(sequence, scalarDigits, randomLength);
+
+    //Every kernel must give same digits and same windows as scalar code
+    for(unsigned int level = 0; level <= bestLevel; level++)
+    {
+        testEncoder.simdLevel = level;
+        ASSERT_EQ(testEncoder.encodeBlock(sequence, simdDigits, randomLength), scalarInvalid);
+        for(int index = 0; index < randomLength; index++)
+        {
+            ASSERT_EQ(simdDigits[index], scalarDigits[index]) << index;
+        }
+        for(int index = 0; index + QUERY_LENGTH <= randomLength; index++)
+        {
+            bool validFlag = true;
+            unsigned long long windowKey = testEncoder.encodeWindow(sequence, index, validFlag);
+            bool expectedValid = true;
+            for(int digitIndex = index; digitIndex < index + QUERY_LENGTH; digitIndex++)
+            {
+                expectedValid = expectedValid && (scalarDigits[digitIndex] != INVALID_BASE);
+            }
+            ASSERT_EQ(validFlag, expectedValid) << index;
+            if(validFlag)
+            {
+                ASSERT_EQ(windowKey % INDEX_PLACE_VALUE, TestHash.convertToRadix(sequence, index, 12));
+                ASSERT_EQ(windowKey / INDEX_PLACE_VALUE, TestHash.convertToRadix(sequence, index + 12, 4));
+            }
+        }
+    }
+}
+
+TEST(Hash, Prefilter)
+{
+    int randomKeys = DeepState_Int64InRange(1, MAX_NUM_QUERIES);
+    BloomFilter testFilter = BloomFilter(randomKeys, 0.01);
+    unsigned long long keyStep = 0x5DEECE66Dull;
+
+    //No key added to filter may ever be rejected
+    for(int index = 0; index < randomKeys; index++)
+    {
+        testFilter.addKey(index * keyStep);
+    }
+    for(int index = 0; index < randomKeys; index++)
+    {
+        ASSERT(testFilter.mayContain(index * keyStep)) << index;
+    }
+
+    //Keys never added should mostly be rejected
+    unsigned int numPassed = 0;
+    for(int index = randomKeys; index < 2 * randomKeys; index++)
+    {
+        numPassed += testFilter.mayContain(index * keyStep);
+    }
+    ASSERT_LE(numPassed, (unsigned int)(0.05 * randomKeys) + 2);
+}
+
+TEST(Hash, ParallelFill)
+{
+    int randomQuery = DeepState_Int64InRange(1, MAX_NUM_QUERIES);
+    int numThreads = DeepState_Int64InRange(2, 8);
+    std::ofstream tempQueryFile("testQueryFile.txt", std::ofstream::binary);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        tempQueryFile.write(DeepState_CStr_C(QUERY_LENGTH, "ACGNT"), sizeof(char)*QUERY_LENGTH);
+    }
+    tempQueryFile.close();
+
+    FILE *queryFile = fopen("testQueryFile.txt", "r");
+    unsigned int tableSize = findTableSize(countQueries(queryFile), DEFAULT_LOAD_FACTOR);
+    Queries_HT serialTable = Queries_HT(queryFile, tableSize);
+    Queries_HT parallelTable = Queries_HT(queryFile, tableSize);
+    unsigned int serialCollisions = serialTable.fillHashes(false);
+    unsigned int parallelCollisions = parallelTable.fillHashes(false, numThreads);
+
+    ASSERT_EQ(serialTable.numQueries, parallelTable.numQueries);
+    ASSERT_EQ(serialTable.hashTableSize, parallelTable.hashTableSize);
+    ASSERT_EQ(parallelCollisions, serialCollisions);
+
+    //Every list must hold same nodes in same order
+    for(unsigned int index = 0; index < serialTable.hashTableSize; index++)
+    {
+        unsigned int serialNode = serialTable.hashArray[index].headPtr;
+        unsigned int parallelNode = parallelTable.hashArray[index].headPtr;
+        while(serialNode != NULL_NODE && parallelNode != NULL_NODE)
+        {
+            LLNode &serialEntry = serialTable.nodeArena.getNode(serialNode);
+            LLNode &parallelEntry = parallelTable.nodeArena.getNode(parallelNode);
+            ASSERT_EQ(serialEntry.indexValue, parallelEntry.indexValue);
+            ASSERT_EQ(serialEntry.radixValue, parallelEntry.radixValue);
+            serialNode = serialEntry.nextNode;
+            parallelNode = parallelEntry.nextNode;
+        }
+        ASSERT_EQ(serialNode, parallelNode);
+    }
+
+    fclose(queryFile);
+}
+
+TEST(Hash, IndexFile)
+{
+    int randomQuery = DeepState_Int64InRange(1, MAX_NUM_QUERIES);
+    std::ofstream tempQueryFile("testQueryFile.txt", std::ofstream::binary);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        tempQueryFile.write(DeepState_CStr_C(QUERY_LENGTH, "ACGNT"), sizeof(char)*QUERY_LENGTH);
+    }
+    tempQueryFile.close();
+
+    FILE *queryFile = fopen("testQueryFile.txt", "r");
+    Queries_HT builtTable = Queries_HT(queryFile, findTableSize(countQueries(queryFile), DEFAULT_LOAD_FACTOR));
+    builtTable.fillHashes(false);
+    fclose(queryFile);
+    ASSERT(builtTable.writeIndex("testQueryIndex.bin"));
+
+    //Mapped table must answer every window same as built table
+    Queries_HT loadedTable;
+    ASSERT(loadedTable.loadIndex("testQueryIndex.bin", true));
+    ASSERT_EQ(loadedTable.numQueries, builtTable.numQueries);
+    ASSERT_EQ(loadedTable.hashTableSize, builtTable.hashTableSize);
+    char *sequence = DeepState_CStr_C(200, "ACGNT");
+    for(int index = 0; index + QUERY_LENGTH <= 200; index++)
+    {
+        ASSERT_EQ(loadedTable.searchHash(sequence, index), builtTable.searchHash(sequence, index)) << index;
+    }
+
+    //Damaged file must be refused
+    FILE *indexFile = fopen("testQueryIndex.bin", "r+b");
+    fseek(indexFile, INDEX_HEADER_BYTES, SEEK_SET);
+    int headByte = fgetc(indexFile);
+    fseek(indexFile, INDEX_HEADER_BYTES, SEEK_SET);
+    fputc(headByte ^ 0x5A, indexFile);
+    fclose(indexFile);
+    Queries_HT damagedTable;
+    ASSERT(!damagedTable.loadIndex("testQueryIndex.bin", true));
+}
+
+TEST(Program, Streaming)
+{
+    //Genome split over several records and short lines
+    char *sequence = DeepState_CStr_C(400, "ACGNT");
+    FILE *genomeFile = tmpfile();
+    for(int index = 0; index < 400; index += 40)
+    {
+        fprintf(genomeFile, ">record%d\n%.20s\n%.20s\n", index, sequence + index, sequence + index + 20);
+    }
+    rewind(genomeFile);
+
+    //Plant random genome windows as queries
+    Queries_FlatHT flatTable = Queries_FlatHT(NULL, 64);
+    int randomQuery = DeepState_Int64InRange(1, 30);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        flatTable.insertSequence(sequence + DeepState_Int64InRange(0, 400 - QUERY_LENGTH));
+    }
+
+    //Any chunk size must give same matches as scanning whole file
+    unsigned long long chunkLength = DeepState_Int64InRange(QUERY_LENGTH, 100);
+    FastaReader streamReader;
+    ScanResult streamResult = streamGenome(flatTable, genomeFile, streamReader, chunkLength, 2);
+    rewind(genomeFile);
+    FastaReader wholeReader;
+    wholeReader.readFile(genomeFile);
+    ScanResult wholeResult = searchGenome(flatTable, wholeReader.sequenceBuffer,
+                                            wholeReader.sequenceLength - QUERY_LENGTH + 1, 1);
+    fclose(genomeFile);
+    ASSERT_EQ(streamResult.numMatches, wholeResult.numMatches);
+    ASSERT_EQ(streamReader.recordStarts.size(), 10);
+    for(unsigned int index = 0; index < wholeResult.numMatches; index++)
+    {
+        ASSERT_EQ(streamResult.matchPositions[index], wholeResult.matchPositions[index]);
+        ASSERT_EQ(streamResult.matchKeys[index], wholeResult.matchKeys[index]);
+
+        //Match must lie inside one 40 character record
+        unsigned int genomeRecord = wholeReader.findRecord(wholeResult.matchPositions[index]);
+        unsigned long long recordOffset = wholeResult.matchPositions[index] - wholeReader.recordStarts[genomeRecord];
+        ASSERT_LE(recordOffset + QUERY_LENGTH, 40);
+        ASSERT_EQ(strncmp(sequence + (genomeRecord * 40) + recordOffset,
+                            wholeReader.sequenceBuffer + wholeResult.matchPositions[index], QUERY_LENGTH), 0);
+    }
+}
+
+TEST(Program, MatchReport)
+{
+    //Low complexity genome in several records gives many matches
+    char *sequence = DeepState_CStr_C(600, "AC");
+    FILE *genomeFile = tmpfile();
+    FILE *queryFile = tmpfile();
+    for(int index = 0; index < 600; index += 60)
+    {
+        fprintf(genomeFile, ">record%d\n%.60s\n", index, sequence + index);
+    }
+    int randomQuery = DeepState_Int64InRange(1, 30);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        fprintf(queryFile, ">query%d\n%.16s\n", index, sequence + DeepState_Int64InRange(0, 600 - QUERY_LENGTH));
+    }
+    rewind(genomeFile);
+    rewind(queryFile);
+    Queries_FlatHT flatTable = Queries_FlatHT(queryFile, 64);
+    flatTable.fillHashes(false);
+
+    //Without reporting only printed matches are kept, every match is still counted
+    FastaReader wholeReader;
+    wholeReader.readFile(genomeFile);
+    ScanResult keptResult = searchGenome(flatTable, wholeReader.sequenceBuffer,
+                                            wholeReader.sequenceLength - QUERY_LENGTH + 1, 3);
+    ScanResult::keepAllFlag = false;
+    ScanResult limitResult = searchGenome(flatTable, wholeReader.sequenceBuffer,
+                                            wholeReader.sequenceLength - QUERY_LENGTH + 1, 3);
+    ScanResult::keepAllFlag = true;
+    ASSERT_EQ(limitResult.numMatches, keptResult.numMatches);
+    ASSERT_EQ(limitResult.matchPositions.size(), min(keptResult.numMatches, (unsigned long long)MAX_PRINTED_MATCHES));
+    for(unsigned int index = 0; index < limitResult.matchPositions.size(); index++)
+    {
+        ASSERT_EQ(limitResult.matchPositions[index], keptResult.matchPositions[index]);
+    }
+
+    //Report written chunk by chunk must equal report written after whole genome
+    MatchReport wholeReport;
+    MatchReport streamReport;
+    wholeReport.reportFile = tmpfile();
+    streamReport.reportFile = tmpfile();
+    wholeReport.queryCatalog.readCatalog(queryFile);
+    streamReport.queryCatalog.readCatalog(queryFile);
+    wholeReport.writeMatches(keptResult, wholeReader);
+    rewind(genomeFile);
+    FastaReader streamReader;
+    ScanResult streamResult = streamGenome(flatTable, genomeFile, streamReader,
+                                            DeepState_Int64InRange(QUERY_LENGTH, 100), 2, DEFAULT_BATCH, &streamReport);
+    fclose(genomeFile);
+    fclose(queryFile);
+    ASSERT_EQ(streamReport.numWritten, keptResult.numMatches);
+    ASSERT_LE(streamResult.matchPositions.size(), MAX_PRINTED_MATCHES);
+    rewind(wholeReport.reportFile);
+    rewind(streamReport.reportFile);
+    int wholeChar, streamChar;
+    do
+    {
+        wholeChar = fgetc(wholeReport.reportFile);
+        streamChar = fgetc(streamReport.reportFile);
+        ASSERT_EQ(wholeChar, streamChar);
+    } while(wholeChar != EOF);
+}
+
+TEST(Program, PerfCounters)
+{
+    //Counters may be missing on this machine, wall-clock time must work either way
+    char *sequence = DeepState_CStr_C(1000, "ACGNT");
+    int numThreads = DeepState_Int64InRange(1, 4);
+    Queries_FlatHT flatTable = Queries_FlatHT(NULL, 64);
+    flatTable.insertSequence(sequence);
+    PerfCounters::countingFlag = true;
+    ScanResult scanResult = searchGenome(flatTable, sequence, 1000 - QUERY_LENGTH + 1, numThreads);
+    ScanResult repeatResult = searchGenome(flatTable, sequence, 1000 - QUERY_LENGTH + 1, numThreads);
+    PerfCounters::countingFlag = false;
+
+    //One set of counters per scan thread, merging adds them thread by thread
+    ASSERT_EQ(scanResult.threadCounters.size(), numThreads);
+    ASSERT_GE(scanResult.numMatches, 1);
+    ScanResult totalResult;
+    totalResult.mergeResult(scanResult);
+    totalResult.mergeResult(repeatResult);
+    ASSERT_EQ(totalResult.threadCounters.size(), numThreads);
+    for(int index = 0; index < numThreads; index++)
+    {
+        ASSERT_GE(scanResult.threadCounters[index].wallUSec, 0);
+        ASSERT_EQ(totalResult.threadCounters[index].wallUSec,
+                    scanResult.threadCounters[index].wallUSec + repeatResult.threadCounters[index].wallUSec);
+        ASSERT_EQ(totalResult.threadCounters[index].counterValues[0],
+                    scanResult.threadCounters[index].counterValues[0] + repeatResult.threadCounters[index].counterValues[0]);
+    }
+}
+
+TEST(Program, Workload)
+{
+    //Random settings, N runs long enough to cover planted windows now and then
+    WorkloadGenerator workloadGenerator(DeepState_UInt64());
+    workloadGenerator.genomeLength = DeepState_Int64InRange(QUERY_LENGTH, 200000);
+    workloadGenerator.numQueries = DeepState_Int64InRange(1, 2000);
+    workloadGenerator.plantedFraction = DeepState_Int64InRange(0, 10) / 20.0;
+    workloadGenerator.duplicateFraction = DeepState_Int64InRange(0, 10) / 20.0;
+    workloadGenerator.nRunRate = DeepState_Int64InRange(0, 2000);
+    workloadGenerator.nRunLength = DeepState_Int64InRange(1, 50);
+    FILE *genomeFile = tmpfile();
+    FILE *queryFile = tmpfile();
+    ASSERT(workloadGenerator.generate(genomeFile, queryFile));
+    ASSERT_EQ(workloadGenerator.numPlanted + workloadGenerator.numDuplicates + workloadGenerator.numRandom,
+                workloadGenerator.numQueries);
+
+    //Engine must find exactly expected number of matches
+    rewind(genomeFile);
+    rewind(queryFile);
+    FastaReader genomeReader;
+    genomeReader.readFile(genomeFile);
+    ASSERT_EQ(genomeReader.sequenceLength, workloadGenerator.genomeLength);
+    ASSERT_EQ(countQueries(queryFile), workloadGenerator.numQueries);
+    Queries_HT chainTable = Queries_HT(queryFile, findTableSize(workloadGenerator.numQueries, DEFAULT_LOAD_FACTOR));
+    chainTable.fillHashes(false);
+    ScanResult scanResult = searchGenome(chainTable, genomeReader.sequenceBuffer,
+                                            genomeReader.sequenceLength - QUERY_LENGTH + 1, 2);
+    ASSERT_EQ(scanResult.numMatches, workloadGenerator.expectedMatches);
+    ASSERT_GE(scanResult.numMatches, (workloadGenerator.numPlanted > 0) ? 1 : 0);
+
+    //Same seed must write same files again
+    FILE *repeatGenome = tmpfile();
+    FILE *repeatQuery = tmpfile();
+    unsigned long long expectedMatches = workloadGenerator.expectedMatches;
+    ASSERT(workloadGenerator.generate(repeatGenome, repeatQuery));
+    ASSERT_EQ(workloadGenerator.expectedMatches, expectedMatches);
+    FILE *firstFiles[2] = {genomeFile, queryFile};
+    FILE *repeatFiles[2] = {repeatGenome, repeatQuery};
+    for(int fileIndex = 0; fileIndex < 2; fileIndex++)
+    {
+        rewind(firstFiles[fileIndex]);
+        rewind(repeatFiles[fileIndex]);
+        int firstChar = fgetc(firstFiles[fileIndex]);
+        int repeatChar = fgetc(repeatFiles[fileIndex]);
+        while(firstChar != EOF && firstChar == repeatChar)
+        {
+            firstChar = fgetc(firstFiles[fileIndex]);
+            repeatChar = fgetc(repeatFiles[fileIndex]);
+        }
+        ASSERT_EQ(firstChar, repeatChar) << fileIndex;
+        fclose(firstFiles[fileIndex]);
+        fclose(repeatFiles[fileIndex]);
+    }
+}
+
+TEST(Program, Execution)
+{
+    int randomQuery = DeepState_Int64InRange(1, MAX_NUM_QUERIES);
+    int randomGenomeLength = DeepState_Int64InRange(QUERY_LENGTH, MAX_GENOME_LENGTH);
+    char **queries = (char**)malloc(sizeof(char*) * randomQuery);
+    char *genome = (char*)malloc(sizeof(char) * randomGenomeLength);
+    std::ofstream tempQueryFile("testQueryFile.txt", std::ofstream::binary);
+    std::ofstream tempGenomeFile("testGenomeFile.txt", std::ofstream::binary);
+    for(int index = 0; index < randomQuery; index++)
+    {
+        queries[index] = (char*)malloc(sizeof(char) * QUERY_LENGTH);
+        queries[index] = DeepState_CStr_C(QUERY_LENGTH, "ACGNT");
+        tempQueryFile.write(queries[index], sizeof(char)*QUERY_LENGTH);
+    }
+    genome = DeepState_CStr_C(randomGenomeLength, "ACGNT");
+    tempGenomeFile.write(genome, sizeof(char)*randomGenomeLength);
+
+    tempGenomeFile.close();
+    tempQueryFile.close();
+
+    FILE *queryFile = fopen("testQueryFile.txt", "r");
+    FILE *genomeFile = fopen("testGenomeFile.txt", "r");
+
+    Queries_HT queryTable = Queries_HT(queryFile, findTableSize(countQueries(queryFile), DEFAULT_LOAD_FACTOR));
+    unsigned int numCollisions = queryTable.fillHashes(false);
+
+    ASSERT_GE(queryTable.numQueries, randomQuery);
+    ASSERT_LE(queryTable.numQueries, DEFAULT_LOAD_FACTOR * queryTable.hashTableSize);
+
+    FastaReader genomeReader;
+    ASSERT(genomeReader.readFile(genomeFile));
+    unsigned int genomeLength = (unsigned int)genomeReader.sequenceLength;
+    ASSERT_EQ(genomeLength, randomGenomeLength) << randomGenomeLength;
+    char *genomeString = genomeReader.sequenceBuffer;
+
+    unsigned int numSubstrings = genomeLength - QUERY_LENGTH + 1;
+    unsigned int numMatches = 0;
+    KmerEncoder windowEncoder;
+    unsigned long long windowKey = windowEncoder.startWindow(genomeString, 0);
+
+    for(unsigned int index = 0; index < numSubstrings; index++)
+        {
+            if(index > 0)
+            {
+                windowKey = windowEncoder.rollWindow(genomeString[index + QUERY_LENGTH - 1]);
+            }
+            ASSERT_EQ(queryTable.searchKey(windowKey), queryTable.searchHash(genomeString, index));
+
+            //Check for successful search
+            if(queryTable.searchHash(genomeString, index))
+            {
+                //Increment number of found matches
+                numMatches += 1;
+            }
+        }
+
+    ScanResult threadedResult = searchGenome(queryTable, genomeString, numSubstrings, 4);
+    ASSERT_EQ(threadedResult.numMatches, numMatches);
+
+    fclose(genomeFile);
+    fclose(queryFile);
+}
+
+/*
+TEST(Program, Execution)
+{
+    int fdQuery, fdGenome;
+    fdQuery = open("trimmedQuery.txt", O_RDONLY | O_EXCL);
+    fdGenome = open("trimmedGenome.txt", O_RDONLY | O_EXCL);
+
+    ASSERT_NE(fdQuery, -1);
+    ASSERT_NE(fdGenome, -1);
+
+    FILE *queryFile = fopen("trimmedQuery.txt", "r");
+    FILE *genomeFile = fopen("trimmedGenome.txt", "r");
+
+    Queries_HT sixtyMSize = Queries_HT(queryFile, 60000000);
+    unsigned int numCollisions = sixtyMSize.fillHashes(false);
+
+    unsigned int genomeLength = 0;
+        unsigned int genomeIndex = 0;
+        int intChar = fgetc(genomeFile);
+        while(intChar != EOF)
+        {
+            //Increment length of genome
+            genomeLength += (intChar > 64 && intChar < 91);
+            intChar = fgetc(genomeFile);
+        }
+        ASSERT_GT(genomeLength, 0);
+        char *genomeString = new char[genomeLength+1];
+        fseek(genomeFile, 0, SEEK_SET);
+        intChar = fgetc(genomeFile);
+
+        while(intChar != EOF)
+        {
+            if(intChar > 64 && intChar < 91)
+            {
+                //Increment length of genome
+                genomeString[genomeIndex] = (char)(intChar);
+                genomeIndex++;
+                genomeString[genomeIndex+1] = '\0';
+            }
+            intChar = fgetc(genomeFile);
+        }
+
+    unsigned int numSubstrings = genomeLength - QUERY_LENGTH + 1;
+    unsigned int numMatches = 0;
+
+    for(unsigned int index = 0; index < numSubstrings; index++)
+        {
+            //Check for successful search
+            if(sixtyMSize.searchHash(genomeString, index))
+            {
+                //Increment number of found matches
+                numMatches += 1;
+            }
+        }
+
+    ASSERT_GT(numMatches, 0);
+
+    fclose(genomeFile);
+    fclose(queryFile);
+
+}
 */
\ No newline at end of file